@@ -1,8 +1,66 @@
 #pragma once
 #include "player.h"
 #include "monster.h"
-#include <random>
+#include "damage_table.h"
+#include "battle_profile.h"
+#include "rng.h"
+#include "sim_kernel.h"
+#include "ttk_sketch.h"
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
+
+// Exact distribution of the time to kill, solved over the monster's remaining HP
+struct TTKDistribution {
+    double expectedTicks;
+    double expectedSeconds;
+    double varianceTicks;   // Variance of the kill time in ticks^2
+    double expectedAttacks;
+    int p50Ticks;
+    int p90Ticks;
+    int p99Ticks;
+    bool killable;          // False when no attack can ever deal damage
+    bool percentilesExact;  // False when long fights fit p50/p90/p99 from the moments
+};
+
+// When an adaptive simulation may stop: the 95% confidence interval of the
+// mean kill time must be within relativeError of the mean and/or within
+// ciHalfWidthTicks (0 disables a criterion)
+struct PrecisionTarget {
+    double relativeError {0.01};
+    double ciHalfWidthTicks {0.0};
+    int minFights {256};
+    int maxFights {1000000};
+    bool reduceVariance {false};    // Antithetic pairs with the damage control variate
+};
+
+struct SimulationEstimate {
+    double meanTicks;
+    double stdErrorTicks;       // Standard error of meanTicks
+    double ciHalfWidthTicks;    // 95% confidence interval half-width
+    int fights;                 // Fights simulated
+    bool converged;             // False if maxFights was hit first
+    double varianceReduction;   // Plain-sampling variance over the achieved one (1 = none)
+};
+
+// Everything needed to repeat a seeded runSimulations call exactly. Replaying
+// it on a Battle with the same scenario gives identical tick counts.
+struct RunManifest {
+    uint64_t seed {0};
+    std::string rng;            // kSimRngName, the batched kernel engine, not BattleRng
+    uint64_t scenario {0};      // Battle::scenarioFingerprint() of the run
+    int fights {0};
+    double meanTicks {0.0};     // Result of the run, checked on replay
+
+    // JSON with the 64-bit values as hex strings, safe for JavaScript
+    std::string toJson() const;
+    static bool fromJson(const std::string& text, RunManifest& out);
+};
+
+// Fingerprint of a whole combat state (player and monster), for keying
+// cached results across advisor phases, UI updates or requests
+uint64_t stateFingerprint(const Player& player, const Monster& monster);
 
 struct BattleResult {
     double dps;
@@ -12,6 +70,11 @@ struct BattleResult {
     std::string stance;
     int attackSpeed;
     double avgTTK;
+    double ttkStdDev;
+    double ttkP50;
+    double ttkP90;
+    double ttkP99;
+    bool ttkPercentilesExact;
     double killsPerHour;
     bool isFang;
     bool isDHL;
@@ -23,69 +86,61 @@ struct BattleResult {
     bool hasSalve;
     bool onTask;
     std::string activeSet;
+    std::vector<StanceDPS> stances; // DPS of every stance of the chosen style family
+    
+    // Kill-time percentiles (seconds) and histogram of the last runSimulations
+    // call, if it simulated the attack getResults chose; 0 and empty otherwise
+    double simTTKP50;
+    double simTTKP90;
+    double simTTKP99;
+    TTKHistogram ttkHistogram;
 };
 
 class Battle {
     private:
         Player player_;  // Copy for WASM compatibility
         Monster monster_;
-        std::mt19937 gen;
+        BattleRng gen;
+        uint64_t seed_ {0};
+        RunManifest lastRun_;
+        std::shared_ptr<const TTKSketch> lastSketch_;  // Set by runSimulations only
+        
+        // Gear and monster resolved once; every formula below reads from it
+        BattleProfile profile_;
         
         std::string style_; // "stab", "slash", "crush", "ranged"
+        CombatStyle combatStyle_ {CombatStyle::Stab};
         int attack_speed_;
-        bool isFang_ {false};
-        bool isDHL_ {false};
-        bool isRanged_ {false};
-        bool isDHCB_ {false};
-        bool isArclight_ {false};
-        bool isKeris_ {false};
-        bool isKerisBreaching_ {false};
-        bool isLeafBladed_ {false};
-        bool isScythe_ {false};
-        bool isTbow_ {false};
-        bool isDharok_ {false};
-        
-        bool isDragon_ {false};
-        bool isUndead_ {false};
-        bool isDemon_ {false};
-        bool isKalphite_ {false};
-        bool isLeafy_ {false};
-        bool isVampyre_ {false};
-        bool isShade_ {false};
-        bool isXerician_ {false};
-        
-        bool hasSalve_ {false};
-        bool hasSalveE_ {false};
-        bool hasSalveI_ {false};
-        bool hasSalveEI_ {false};
-        
-        bool isOnTask_ {false};
         std::string activeSet_;
-
         
         int stance_bonus_attack_ {0};
         int stance_bonus_strength_ {0};
+        std::string stanceName_;
         
-        int invalid_ranged_str_ {0};
-        int invalid_ranged_att_ {0};
+        // Damage table of the current style/stance, rebuilt when either changes
+        DamageTable damageTable_;
+        bool damageTableValid_ {false};
+        CombatStyle tableStyle_ {CombatStyle::Stab};
+        int tableStanceAttack_ {0};
+        int tableStanceStrength_ {0};
 
         // Formulas
         void init();
-        int effectiveStrength();
+        void setStyle(CombatStyle style);
 
-        int maxHit();
-        int effectiveAttack();
-        int attackRoll();
-        int defenceRoll();
-        double hitChance();
-        
-        int bernoulliTrial(double p);
-        int randomDamage(int max);
+        int maxHit() const;
+        int attackRoll() const;
+        int defenceRoll() const;
+        double hitChance() const;
+        
+        // Current attack: max hit, accuracy and special rolls
+        AttackShape attackShape() const;
+        const DamageTable& damageTable();
+        
+        // Current attack resolved for the Monte Carlo kernels
+        SimAttackParams simAttackParams();
 
         void determineStyle(); // Default logic
-        
-        // Helper to calculate theoretical DPS for a given style/stance
-        double calculateDPS(const std::string& style, int stanceAtt, int stanceStr);
 
     public:
         Battle(Player& p, Monster& m);
@@ -94,15 +149,66 @@ class Battle {
         // Returns ticks to kill
         int simulate(); 
         
+        // Same, drawing from any 64-bit engine (see rng.h)
+        template <class Rng>
+        int simulate(Rng& rng) {
+            SimAttackParams params = simAttackParams();
+            if (params.hp > 0 && !damageTable().canDamage()) return 0;
+            return static_cast<int>(simulateFight(rng, params)) * attack_speed_;
+        }
+        
+        // Reseeds the battle's generator: simulate() and the overloads without
+        // a seed argument repeat exactly after the same setSeed call.
+        // Battles start from a distinct random seed.
+        void setSeed(uint64_t seed);
+        uint64_t getSeed() const { return seed_; }
+        
+        // Hash of the simulated attack: monster HP, attack speed and the
+        // damage distribution. Equal fingerprints simulate identical fights.
+        uint64_t scenarioFingerprint();
+        
+        // Manifest and kill-time distribution of the last runSimulations call
+        // (an empty sketch before the first)
+        const RunManifest& getLastRun() const { return lastRun_; }
+        const TTKSketch& getLastSketch() const;
+        
+        // Reruns a recorded run; false if the scenario or engine differs or
+        // the result does not match
+        bool replay(const RunManifest& manifest, int threads = 0);
+        
         // Runs n simulations and returns avg ticks
         double runSimulations(int n);
         
+        // Splits n fights across worker threads (0 = hardware concurrency),
+        // each running the batched lockstep kernel. Fights are seeded per
+        // fixed-size chunk, so a given seed gives the same result for any
+        // thread count and any SIMD backend.
+        double runSimulations(int n, int threads, uint64_t seed);
+        
+        // Antithetic fight pairs with total damage as a control variate:
+        // the damage dealt has known mean (attacks x mean damage per attack),
+        // so its sampled deviation corrects the attack count. Reports the
+        // variance reduction over plain sampling of the same fights.
+        SimulationEstimate runSimulationsReduced(int n, int threads, uint64_t seed);
+        
+        // Simulates in growing rounds until the target precision is met or
+        // maxFights is reached. Deterministic for a given seed and target,
+        // whatever the thread count.
+        SimulationEstimate runSimulationsAdaptive(double relativeError, int maxFights);
+        SimulationEstimate runSimulationsAdaptive(const PrecisionTarget& target, int threads, uint64_t seed);
+        
+        // Exact expected TTK, variance and percentiles for the current style (no sampling)
+        TTKDistribution solveTTK();
+        
         // Tests styles and sets the best one
         void optimizeAttackStyle(); 
         
         // Returns the max theoretical DPS achievable with current gear
         double solveOptimalDPS();
         
+        // Max hit, accuracy and DPS of every stance, computed in one pass
+        StanceTable getStanceTable() const { return profile_.stanceTable(); }
+        
         // Getters for UI
         std::string getStyle() const { return style_; }
         int getAttackSpeed() const { return attack_speed_; }
@@ -112,7 +218,9 @@ class Battle {
         BattleResult getResults();
         
         // Special effect indicators
-        bool hasFang() const { return isFang_; }
-        bool hasDHL() const { return isDHL_; }
-        bool hasAnySalve() const { return hasSalve_ || hasSalveE_ || hasSalveI_ || hasSalveEI_; }
+        bool hasFang() const { return profile_.isFang; }
+        bool hasDHL() const { return profile_.isDHL; }
+        bool hasAnySalve() const { return profile_.hasSalve; }
+        
+        const BattleProfile& getProfile() const { return profile_; }
 };
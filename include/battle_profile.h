@@ -0,0 +1,118 @@
+#pragma once
+#include "player.h"
+#include "monster.h"
+#include "damage_table.h"
+#include "loadout.h"
+
+enum class CombatStyle { Stab = 0, Slash = 1, Crush = 2, Ranged = 3 };
+
+CombatStyle combatStyleFromString(const std::string& style);
+const char* combatStyleName(CombatStyle style);
+
+// One selectable attack stance
+struct StanceOption {
+    CombatStyle style;
+    const char* name;   // "Accurate", "Aggressive", "Controlled", ...
+    int stanceAttack;
+    int stanceStrength;
+    int speedDelta;     // Rapid attacks one tick faster
+};
+
+// One row of the stance table
+struct StanceDPS {
+    StanceOption option;
+    int attackSpeed;
+    int maxHit;
+    double hitChance;
+    double dps;
+};
+
+// Every stance of a style family: 4 per melee style or 3 ranged
+constexpr int kMaxStances = 12;
+struct StanceTable {
+    StanceDPS rows[kMaxStances];
+    int count {0};
+    int best {-1};      // Highest DPS, first on ties
+};
+
+// Everything combat needs from a (Player, Monster) pair, resolved once:
+// levels after potions/prayers/sets, summed gear bonuses, the multiplier
+// chains of every special effect and the monster's defence. Evaluating an
+// attack from it is pure arithmetic with no gear or string lookups.
+struct BattleProfile {
+    // Levels before stance bonuses (potion, prayer and void already applied)
+    int meleeAttackLevel {1};
+    int meleeStrengthLevel {1};
+    int rangedAttackLevel {1};
+    int rangedStrengthLevel {1};
+
+    // Summed equipment bonuses (stab, slash, crush, ranged)
+    int equipAttack[4] {0, 0, 0, 0};
+    int meleeStrength {0};
+    int rangedStrength {0};
+
+    // Ammo the weapon cannot fire does not count towards ranged bonuses
+    int invalidRangedAttack {0};
+    int invalidRangedStrength {0};
+
+    // Multiplier chains in the order the formulas apply them; the crush-only
+    // Inquisitor bonus and Dharok's HP bonus are applied on top.
+    double meleeDamageMult {1.0};
+    double meleeAccuracyMult {1.0};
+    double rangedDamageMult {1.0};
+    double rangedAccuracyMult {1.0};
+    bool inquisitorSet {false};
+    int inquisitorPieces {0};
+    bool dharok {false};
+    double dharokMult {1.0};
+
+    int weaponSpeed {4};
+    int hits {1};           // Rolls per attack (scythe on size 2/3+)
+    bool kerisCrit {false}; // Keris 1/51 triple damage on kalphites
+
+    // Monster
+    int monsterHP {0};
+    int defenceRolls[4] {0, 0, 0, 0};   // By CombatStyle, from MonsterCombat
+
+    // Effect flags reported to the UI
+    bool isFang {false};
+    bool isDHL {false};
+    bool isDHCB {false};
+    bool isArclight {false};
+    bool isKeris {false};
+    bool isScythe {false};
+    bool isTbow {false};
+    bool hasSalve {false};
+    bool onTask {false};
+
+    static BattleProfile compile(const Player& player, const Monster& monster);
+    // Same for the player wearing `gear` instead of their own equipment
+    static BattleProfile compile(const Player& player, const Loadout& gear, const Monster& monster);
+
+    // Highest-bonus style, used as the starting point before optimisation
+    CombatStyle defaultStyle() const;
+
+    int effectiveAttack(CombatStyle style, int stanceAttack) const;
+    int effectiveStrength(CombatStyle style, int stanceStrength) const;
+    int maxHit(CombatStyle style, int stanceStrength) const;
+    int attackRoll(CombatStyle style, int stanceAttack) const;
+    int defenceRoll(CombatStyle style) const;
+    double hitChance(CombatStyle style, int stanceAttack) const;
+    AttackShape attackShape(CombatStyle style, int stanceAttack, int stanceStrength) const;
+    double dps(CombatStyle style, int stanceAttack, int stanceStrength, int attackSpeed) const;
+
+    // Every stance of the default style family in one pass: the multipliers,
+    // bonuses and defence roll of a style are shared by all its stances.
+    StanceTable stanceTable() const;
+
+    // Best stance for the default style. Pure arithmetic with no allocation,
+    // so it can run once per candidate in search loops.
+    StanceDPS bestStance() const;
+    double optimalDPS() const { return bestStance().dps; }
+
+    // Terms shared by every stance of a style
+    int attackBonus(CombatStyle style) const;
+    int strengthBonus(CombatStyle style) const;
+    double damageMultiplier(CombatStyle style) const;
+    double accuracyMultiplier(CombatStyle style) const;
+};
@@ -0,0 +1,153 @@
+// binary_db.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "item.h"
+#include "item_arena.h"
+#include "monster.h"
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+// Fixed-layout database of items, monsters and prices, compiled from the
+// wiki JSON dumps by the osrsdb tool and read in place from a memory map.
+// All integers are little-endian; tables start on 8-byte boundaries and
+// strings live in one blob, referenced by offset and length.
+namespace binarydb {
+
+constexpr char kMagic[8] = {'O', 'S', 'R', 'S', 'D', 'B', '\0', '\0'};
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;         // kByteOrderMark as written
+    uint32_t itemStatCount;     // kItemStatCount the file was built with
+    uint32_t itemCount;
+    uint32_t monsterCount;
+    uint32_t priceCount;
+    uint64_t itemsOffset;
+    uint64_t monstersOffset;
+    uint64_t pricesOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+static_assert(sizeof(Header) == 72, "Header layout is part of the file format");
+
+constexpr uint32_t kItemTradeable = 1u << 0;    // tradeable_on_ge
+constexpr uint32_t kItemEquipable = 1u << 1;    // equipable_by_player
+
+// One equipable item, sorted by id, with its traits resolved at compile time
+struct ItemRecord {
+    int32_t id;
+    uint32_t flags;
+    uint64_t effects;       // ItemEffects
+    StringRef name;
+    StringRef slot;
+    StringRef weaponType;
+    uint8_t weaponClass;    // WeaponClass
+    uint8_t ammoClass;      // AmmoClass
+    uint8_t reserved[6];
+    int32_t stats[kItemStatCount];  // By ItemStat
+};
+static_assert(sizeof(ItemRecord) == 48 + 4 * kItemStatCount, "ItemRecord layout is part of the file format");
+
+// Integer monster fields kept, in MonsterRecord::fields order
+enum MonsterField {
+    Hitpoints, CombatLevel, AttackLevel, StrengthLevel, DefenceLevel, MagicLevel, RangedLevel,
+    MaxHit, AttackSpeed, Size, DefenceStab, DefenceSlash, DefenceCrush, DefenceMagic, DefenceRanged,
+    kMonsterFieldCount
+};
+
+constexpr uint32_t kMonsterPrefixMatch = 1u << 0;   // From an array file: name prefix matches
+
+// One monster, in input file order
+struct MonsterRecord {
+    StringRef name;
+    uint32_t source;        // Index of the input file, searched in order
+    uint32_t flags;
+    uint32_t present;       // Bit per MonsterField given in the source
+    uint32_t attributes;    // MonsterAttribute bits
+    uint32_t vampyreTier;
+    int32_t fields[kMonsterFieldCount];
+};
+static_assert(sizeof(MonsterRecord) == 28 + 4 * kMonsterFieldCount, "MonsterRecord layout is part of the file format");
+
+// latest_prices.json entry, sorted by id
+struct PriceRecord {
+    int32_t id;
+    int32_t high;
+    int32_t low;
+};
+static_assert(sizeof(PriceRecord) == 12, "PriceRecord layout is part of the file format");
+
+// Builds the file contents. Monster sources are searched in the given order,
+// as loadFromJSON is tried on one file after another.
+std::string compile(const json& items, const json& prices, const std::vector<json>& monsterSources);
+
+}
+
+// Read-only view of a compiled database. open() maps the file, so records
+// are read in place and processes share one page-cache copy.
+class BinaryDb {
+    private:
+        const char* data_ {nullptr};
+        size_t size_ {0};
+        bool mapped_ {false};
+        std::string owned_;     // Contents when not memory-mapped
+        ItemArena items_;       // Every item record, built once when opened
+
+        const binarydb::Header* header() const { return reinterpret_cast<const binarydb::Header*>(data_); }
+        bool validate();
+        void buildItems();
+        void close();
+
+    public:
+        BinaryDb() = default;
+        ~BinaryDb() { close(); }
+        BinaryDb(const BinaryDb&) = delete;
+        BinaryDb& operator=(const BinaryDb&) = delete;
+
+        // False, with a message on stderr, if the file is missing, from
+        // another format version or truncated
+        bool open(const std::string& path);
+        bool load(std::string contents); // In-memory copy, e.g. for WASM
+
+        bool isOpen() const { return data_ != nullptr; }
+
+        size_t itemCount() const { return isOpen() ? header()->itemCount : 0; }
+        size_t monsterCount() const { return isOpen() ? header()->monsterCount : 0; }
+        size_t priceCount() const { return isOpen() ? header()->priceCount : 0; }
+
+        const binarydb::ItemRecord& itemAt(size_t i) const {
+            return reinterpret_cast<const binarydb::ItemRecord*>(data_ + header()->itemsOffset)[i];
+        }
+        const binarydb::MonsterRecord& monsterAt(size_t i) const {
+            return reinterpret_cast<const binarydb::MonsterRecord*>(data_ + header()->monstersOffset)[i];
+        }
+        std::string_view str(binarydb::StringRef ref) const;
+
+        // Binary searches by id, nullptr when absent
+        const binarydb::ItemRecord* findItem(int id) const;
+        const binarydb::PriceRecord* findPrice(int id) const;
+
+        // Item as fetchStats would build it from the JSON, with the stored
+        // traits instead of matching the name again
+        Item makeItem(const binarydb::ItemRecord& record) const;
+        // The items of the file, built once on open: record i has handle i + 1
+        const ItemArena& items() const { return items_; }
+
+        // Same matching as Monster::loadFromJSON over the source files in
+        // order, moving on to the next file while out has no hitpoints;
+        // fills the stats and attributes of out. False if not found.
+        bool loadMonster(const std::string& name, Monster& out) const;
+};
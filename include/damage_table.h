@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Everything that determines the damage of one attack
+struct AttackShape {
+    int maxHit;
+    double accuracy;
+    int hits;        // Rolls per attack (scythe: 1-3, at max, max / 2, max / 4)
+    bool fang;       // Rolls clamped to 15-85% of their max
+    bool kerisCrit;  // 1/51 chance to triple the first roll
+};
+
+// Damage distribution of one full attack with the accuracy roll folded in,
+// plus a Walker/Vose alias table so a sample costs one lookup.
+// Shared by the simulators, the analytic DPS and the TTK solver.
+class DamageTable {
+    private:
+        std::vector<double> pmf_;
+        std::vector<uint32_t> accept_; // Per-column acceptance threshold scaled to 2^24
+        std::vector<uint32_t> alias_;
+        double mean_ {0.0};
+        bool canDamage_ {false};       // Some sample of the quantised table is above 0
+
+    public:
+        DamageTable() = default;
+        explicit DamageTable(const AttackShape& shape);
+
+        // Expected damage of one attack without building the table
+        static double expectedDamage(const AttackShape& shape);
+
+        const std::vector<double>& pmf() const { return pmf_; }
+        const uint32_t* acceptData() const { return accept_.data(); }
+        const uint32_t* aliasData() const { return alias_.data(); }
+        int columns() const { return static_cast<int>(pmf_.size()); }
+        int maxDamage() const { return static_cast<int>(pmf_.size()) - 1; }
+        double mean() const { return mean_; }
+        bool canDamage() const { return canDamage_; }
+
+        // Low 32 bits pick the column, top 24 bits decide between it and its alias
+        int sample(uint64_t u) const {
+            uint32_t col = static_cast<uint32_t>(((u & 0xFFFFFFFFull) * accept_.size()) >> 32);
+            return static_cast<uint32_t>(u >> 40) < accept_[col] ? static_cast<int>(col)
+                                                                 : static_cast<int>(alias_[col]);
+        }
+};
@@ -0,0 +1,42 @@
+// fingerprint.h
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Zobrist-style state fingerprints: every (feature, value) pair maps to a
+// pseudo-random 64-bit key and a state's fingerprint is the XOR of the keys
+// of its features. A change XORs the old key out and the new one in, and
+// equal states have equal fingerprints in any process.
+
+// Features, combined with an index into zobristKey's first argument
+enum class FingerprintFeature : uint64_t {
+    Gear = 1, Level, Flag, Hitpoints, MonsterInt, MonsterStr, MonsterBool, MonsterAttributes, Monster
+};
+
+inline uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline uint64_t zobristKey(FingerprintFeature feature, uint64_t index, uint64_t value) {
+    uint64_t f = (static_cast<uint64_t>(feature) << 32) ^ index;
+    return mix64(mix64(f * 0x9E3779B97F4A7C15ull) ^ value);
+}
+
+// FNV-1a, for folding strings into a key value
+inline uint64_t hashString(const std::string& s, uint64_t h = 0xCBF29CE484222325ull) {
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+// 16 hex digits, for JavaScript and JSON which cannot hold 64-bit integers
+inline std::string fingerprintHex(uint64_t fingerprint) {
+    char buf[17];
+    std::snprintf(buf, sizeof buf, "%016llx", static_cast<unsigned long long>(fingerprint));
+    return buf;
+}
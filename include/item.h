@@ -3,13 +3,35 @@
 #include <string>
 #include <map>
 #include "json.hpp"
+#include "item_effects.h"
 
 using json = nlohmann::json;
 
+// Integer stats combat reads, stored in fixed slots instead of the string maps
+enum class ItemStat {
+    AttackStab, AttackSlash, AttackCrush, AttackMagic, AttackRanged,
+    DefenceStab, DefenceSlash, DefenceCrush, DefenceMagic, DefenceRanged,
+    MeleeStrength, RangedStrength, MagicDamage, Prayer,
+    StrengthBonus,  // Older name of melee_strength, still found in some data
+    AttackSpeed
+};
+constexpr int kItemStatCount = 16;
+
+// Item JSON key of a stat, and the stat of a key (-1 if it has no slot)
+const char* itemStatKey(ItemStat stat);
+int itemStatIndex(const std::string& key);
+
 class Item {
     private:
         int id_ {-1};
         std::string name_;
+        int stats_[kItemStatCount] {};
+        std::string slot_;          // "head", "2h", ...
+        std::string weaponType_;    // "bow", "crossbow", ...
+        mutable ItemTraits traits_;         // Resolved from the ID or name on first read
+        mutable bool traitsResolved_ {false};
+        
+        // Everything else, rarely read
         std::map<std::string, int> stats_int_;
         std::map<std::string, std::string> stats_str_;
         std::map<std::string, bool> stats_bool_;
@@ -17,40 +39,65 @@ class Item {
         
         // Helper to parse stats from a JSON object
         void parseItemJSON(const json& item);
+        void resolveTraits() const;
 
     public:
         Item() = default;
         Item(std::string n);
         Item(int id);
+        // Definition whose traits are already resolved (binary database)
+        Item(int id, std::string name, std::string slot, std::string weaponType, const ItemTraits& traits);
         
         void fetchStats(const std::string &filepath);
         void fetchStats(int id, const json& allItems);
         
         // Setters for WASM
-        void setInt(const std::string& key, int value) { stats_int_[key] = value; }
-        void setStr(const std::string& key, const std::string& value) { stats_str_[key] = value; }
+        void setInt(const std::string& key, int value);
+        void setStr(const std::string& key, const std::string& value);
         void setBool(const std::string& key, bool value) { stats_bool_[key] = value; }
-        void setName(const std::string& n) { name_ = n; }
-        void setID(int id) { id_ = id; }
+        void setName(const std::string& n) { name_ = n; traitsResolved_ = false; }
+        void setID(int id) { id_ = id; traitsResolved_ = false; }
         void setPrice(int price) { price_ = price; }
         
         // Getters
         int getPrice() const { return price_; }
         int getID() const { return id_; }
-        std::string getName() const { return name_; }
+        const std::string& getName() const { return name_; }
+        // Traits are resolved on the first read after the name or ID is set,
+        // so read them once before sharing the Item between threads
+        const ItemTraits& traits() const {
+            if (!traitsResolved_) resolveTraits();
+            return traits_;
+        }
+        bool hasEffect(ItemEffect effect) const { return (traits().effects & effectBit(effect)) != 0; }
+        ItemEffects getEffects() const { return traits().effects; }
+        WeaponClass getWeaponClass() const { return traits().weaponClass; }
+        AmmoClass getAmmoClass() const { return traits().ammoClass; }
 
-        int getInt(const std::string& key) const { 
-            auto it = stats_int_.find(key);
-            return (it != stats_int_.end()) ? it->second : 0;
+        int getStat(ItemStat stat) const { return stats_[static_cast<int>(stat)]; }
+        void setStat(ItemStat stat, int value) { stats_[static_cast<int>(stat)] = value; }
+        // totals[i] += sign * stat i, for running sums over equipped items
+        void accumulateStats(int* totals, int sign) const {
+            for (int i = 0; i < kItemStatCount; ++i) totals[i] += sign * stats_[i];
         }
+        const std::string& getSlot() const { return slot_; }
+        bool isTwoHanded() const { return slot_ == "2h"; }
+        const std::string& getWeaponType() const { return weaponType_; }
+
+        // String-keyed access, kept for callers outside combat
+        int getInt(const std::string& key) const;
         bool getBool(const std::string& key) const { 
             auto it = stats_bool_.find(key);
             return (it != stats_bool_.end()) ? it->second : false;
         }
-        std::string getStr(const std::string& key) const { 
-            auto it = stats_str_.find(key);
-            return (it != stats_str_.end()) ? it->second : "";
-        }
+        std::string getStr(const std::string& key) const;
+
+        // Hash of the ID, name and combat stats; equal Items hash equal
+        uint64_t fingerprint() const;
+
+        // Same definition: ID, name, price and every stat
+        bool operator==(const Item& other) const;
+        bool operator!=(const Item& other) const { return !(*this == other); }
         
 #ifndef __EMSCRIPTEN__
         int fetchPrice();
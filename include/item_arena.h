@@ -0,0 +1,39 @@
+// item_arena.h
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include "item.h"
+
+// Handle of an Item in an ItemArena, 0 for no item
+using ItemHandle = uint32_t;
+constexpr ItemHandle kNoItem = 0;
+
+// Item definitions owned by a loaded item database. Each item is added once,
+// when the database loads, at an address that never moves and named by a
+// 32-bit handle, so gear holds handles instead of Item copies. Items live as
+// long as the arena; adding is not thread-safe, get() and find() are.
+class ItemArena {
+    private:
+        std::deque<Item> items_;
+        std::unordered_map<int, ItemHandle> byId_;
+
+    public:
+        ItemArena() = default;
+        ItemArena(const ItemArena&) = delete;
+        ItemArena& operator=(const ItemArena&) = delete;
+
+        // Handle of the new item; find() keeps the first item of an ID
+        ItemHandle add(Item item);
+        void clear();
+
+        // Handle of the item with an ID, kNoItem if there is none
+        ItemHandle find(int id) const {
+            auto it = byId_.find(id);
+            return it != byId_.end() ? it->second : kNoItem;
+        }
+
+        const Item& get(ItemHandle handle) const { return items_[handle - 1]; }
+
+        uint32_t size() const { return static_cast<uint32_t>(items_.size()); }
+};
@@ -0,0 +1,68 @@
+// item_effects.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+// Special effects and set pieces combat cares about, one bit each
+enum class ItemEffect {
+    // Weapons
+    OsmumtensFang, DragonHunterLance, DragonHunterCrossbow, Arclight, Keris, KerisBreaching,
+    LeafBladed, ScytheOfVitur, TwistedBow, DharokGreataxe, ObsidianWeapon,
+    // Amulets: every salve has Salve, the upgrades add their own bit
+    Salve, SalveE, SalveI, SalveEI,
+    // Slayer helmets and black masks; imbued ones have both bits
+    SlayerHelm, SlayerHelmI,
+    // Set pieces
+    VoidMeleeHelm, VoidRangerHelm, VoidMageHelm, VoidTop, EliteVoidTop, VoidRobe, EliteVoidRobe, VoidGloves,
+    CrystalHelm, CrystalBody, CrystalLegs,
+    InquisitorHelm, InquisitorBody, InquisitorLegs,
+    ObsidianHelm, ObsidianBody, ObsidianLegs,
+    DharokHelm, DharokBody, DharokLegs
+};
+
+using ItemEffects = uint64_t;
+
+constexpr ItemEffects effectBit(ItemEffect effect) { return 1ull << static_cast<int>(effect); }
+
+// Ranged weapon families by the ammo they take stats from; Other covers
+// melee, thrown weapons and bows without an ammo slot (crystal bow, bowfa)
+enum class WeaponClass : uint8_t { Other, Bow, Crossbow, KarilsCrossbow, Ballista };
+enum class AmmoClass : uint8_t { None, Arrow, Bolt, BoltRack, Javelin };
+
+// Whether a weapon uses the stats of ammo of this class (table lookup)
+bool ammoCompatible(WeaponClass weapon, AmmoClass ammo);
+
+// Everything the registry resolves for one item
+struct ItemTraits {
+    ItemEffects effects {0};
+    WeaponClass weaponClass {WeaponClass::Other};
+    AmmoClass ammoClass {AmmoClass::None};
+};
+
+// Maps items to their traits. The rule table matches item names once;
+// indexItemDb() runs it over a whole item database when it is loaded so
+// items from it resolve by ID. Items resolve their traits on the first read
+// after their name or ID is set, so combat code only tests bits and tables.
+class ItemEffectRegistry {
+    private:
+        std::unordered_map<int, ItemTraits> byId_;
+
+    public:
+        static ItemEffectRegistry& instance();
+
+        // Traits of an item under the rule table
+        static ItemEffects matchName(const std::string& name);
+        static WeaponClass classifyWeapon(const std::string& name, const std::string& weaponType);
+        static AmmoClass classifyAmmo(const std::string& name);
+
+        // Records the traits of every equipable item in an items-complete
+        // style database (id string -> item object)
+        void indexItemDb(const json& itemDb);
+
+        // By ID when the ID is indexed, otherwise by name and weapon type
+        ItemTraits lookup(int id, const std::string& name, const std::string& weaponType) const;
+};
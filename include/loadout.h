@@ -0,0 +1,68 @@
+// loadout.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include "item.h"
+
+// Equipment slots, named as in the wiki item data
+enum class GearSlot { Head, Cape, Neck, Ammo, Weapon, Shield, Body, Legs, Hands, Feet, Ring };
+constexpr int kGearSlotCount = 11;
+
+// Slot index of a slot name ("2h" maps to the weapon slot), -1 if unknown
+int gearSlotIndex(const std::string& slot);
+const char* gearSlotName(GearSlot slot);
+
+// Armour sets with a combat effect, in detection order: the first complete
+// set wins, so elite void is listed before the plain void it also satisfies
+enum class GearSet {
+    EliteVoidMelee, VoidMelee, EliteVoidRange, VoidRange, EliteVoidMage, VoidMage,
+    Crystal, Inquisitor, Obsidian, Dharok,
+    None
+};
+constexpr int kGearSetCount = 10;
+
+// Display name of a set ("Elite Void Melee"), "" for None
+const char* gearSetName(GearSet set);
+
+// Worn pieces of every GearSet, updated slot by slot as gear changes, so the
+// active set and piece counts are plain reads. Sets are defined by a table
+// of slot -> accepted ItemEffect pieces in loadout.cpp.
+class GearSetTracker {
+    private:
+        uint8_t worn_[kGearSetCount] {};    // Bit per piece of the set's definition
+        GearSet active_ {GearSet::None};
+
+    public:
+        void update(GearSlot slot, const Item* item);
+
+        GearSet active() const { return active_; }
+        int pieces(GearSet set) const; // Pieces worn, complete or not
+};
+
+// Non-owning view of a set of equipment: one Item pointer per slot, null when
+// empty. Cheap to copy, so candidate gear can be tried on without copying the
+// Player or its items. The Items must outlive the view. The summed stats are
+// kept up to date by set(), so swapping an item is one pass over the stats,
+// and so are the worn set pieces.
+class Loadout {
+    private:
+        const Item* items_[kGearSlotCount] {};
+        int bonus_[kItemStatCount] {};
+        GearSetTracker sets_;
+
+    public:
+        const Item* get(GearSlot slot) const { return items_[static_cast<int>(slot)]; }
+        void set(GearSlot slot, const Item* item);
+        // set() plus the equip rules: a two-handed weapon takes off the
+        // shield, a shield takes off a two-handed weapon. A what-if variant
+        // is a copy of the base view (fixed size) with one wear() per change.
+        void wear(GearSlot slot, const Item* item);
+
+        int bonus(ItemStat stat) const { return bonus_[static_cast<int>(stat)]; } // Sum over all items
+        bool hasEquipped(const char* itemName) const;
+
+        // Complete armour set worn, and its name ("" if none)
+        GearSet activeGearSet() const { return sets_.active(); }
+        const char* activeSet() const { return gearSetName(sets_.active()); }
+        int setPieces(GearSet set) const { return sets_.pieces(set); }
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <variant>
@@ -6,15 +7,49 @@
 
 using MonsterValue = std::variant<std::string, int, double, bool>;
 
+// Attributes combat cares about, one bit each in Monster's attribute mask
+enum class MonsterAttribute {
+    Demon, Dragon, Fiery, Golem, Kalphite, Leafy, Penance, Rat, Shade, Spectral, Undead, Vampyre, Xerician
+};
+constexpr int kMonsterAttributeCount = 13;
+
+// "vampyre1".."vampyre3"; a plain "vampyre" has no tier
+enum class VampyreTier : uint8_t { None, Tier1, Tier2, Tier3 };
+
+// Defence bonus order of MonsterCombat; the first four match CombatStyle
+enum class DefenceStyle { Stab, Slash, Crush, Ranged, Magic };
+constexpr int kDefenceStyleCount = 5;
+
+// Everything combat reads from a monster, in plain fields. Monster keeps it
+// up to date as stats and attributes are set, so combat never looks up a
+// stat by name.
+struct MonsterCombat {
+    int hitpoints {0};
+    int defenceLevel {0};
+    int magicLevel {0};
+    int size {1};
+    int defenceBonus[kDefenceStyleCount] {};    // By DefenceStyle
+    int defenceRoll[kDefenceStyleCount] {};     // (defenceLevel + 9) * (bonus + 64)
+    uint32_t attributes {0};                    // Bit per MonsterAttribute
+    VampyreTier vampyreTier {VampyreTier::None};
+};
+
+// Attribute of a JSON attribute string, -1 if it has no bit. Vampyre tiers
+// all map to MonsterAttribute::Vampyre.
+int monsterAttributeIndex(const std::string& attr);
+const char* monsterAttributeName(MonsterAttribute attr);
+
 class Monster {
     private:
         std::string name_;
-        std::map<std::string, int> stats_int_;
-        std::map<std::string, std::string> stats_str_;
+        std::map<std::string, int> stats_int_;              // Loaders keep only combat stats
+        std::map<std::string, std::string> stats_str_;      // Set by callers only
         std::map<std::string, bool> stats_bool_;
-        std::vector<std::string> attributes_;
+        std::vector<std::string> attributes_;   // As loaded, including unknown ones
+        MonsterCombat combat_;                  // Interned on load
         int current_hp_ {0};
-        int size_ {1}; // Default to 1
+
+        void updateCombat(const std::string& key, int value);
     public:
         Monster(std::string n = "");
         void loadFromJSON(const std::string &filepath);
@@ -23,11 +58,12 @@ class Monster {
 
         // Setters for WASM
         void setInt(const std::string& key, int value);
-        void setStr(const std::string& key, const std::string& value) { stats_str_[key] = value; }
+        void setStr(const std::string& key, const std::string& value);
         void setBool(const std::string& key, bool value) { stats_bool_[key] = value; }
         void setName(const std::string& n) { name_ = n; }
-        void addAttribute(const std::string& attr) { attributes_.push_back(attr); }
-        void setSize(int s) { size_ = s; }
+        void addAttribute(const std::string& attr);
+        void clearAttributes();
+        void setSize(int s) { combat_.size = s; }
         
         // Getters
         int getInt(const std::string& key) const;
@@ -36,20 +72,29 @@ class Monster {
         bool hasInt(const std::string& key) const { return stats_int_.count(key) > 0; }
         
         bool hasAttribute(const std::string& attr) const;
+        bool hasAttribute(MonsterAttribute attr) const {
+            return (combat_.attributes >> static_cast<int>(attr)) & 1u;
+        }
+        VampyreTier getVampyreTier() const { return combat_.vampyreTier; }
+        const MonsterCombat& combat() const { return combat_; }
+
+        // Zobrist fingerprint of the name, stats and attributes (not the
+        // current HP of a fight in progress); one pass over the stats
+        uint64_t fingerprint() const;
         std::string getName() const { return name_; }
         int getCurrentHP() const { return current_hp_; }
         void setCurrentHP(int hp) { current_hp_ = hp; }
         void takeDMG(int a) { current_hp_ -= a; }
         void resetHP();
-        int getSize() const { return size_; }
+        int getSize() const { return combat_.size; }
         
         // Attribute helpers
-        bool isDemon() const { return hasAttribute("demon"); }
-        bool isDragon() const { return hasAttribute("dragon"); }
-        bool isKalphite() const { return hasAttribute("kalphite"); }
-        bool isLeafy() const { return hasAttribute("leafy"); }
-        bool isVampyre() const { return hasAttribute("vampyre") || hasAttribute("vampyre1") || hasAttribute("vampyre2") || hasAttribute("vampyre3"); }
-        bool isShade() const { return hasAttribute("shade"); }
-        bool isXerician() const { return hasAttribute("xerician"); }
-        bool isUndead() const { return hasAttribute("undead"); }
+        bool isDemon() const { return hasAttribute(MonsterAttribute::Demon); }
+        bool isDragon() const { return hasAttribute(MonsterAttribute::Dragon); }
+        bool isKalphite() const { return hasAttribute(MonsterAttribute::Kalphite); }
+        bool isLeafy() const { return hasAttribute(MonsterAttribute::Leafy); }
+        bool isVampyre() const { return hasAttribute(MonsterAttribute::Vampyre); }
+        bool isShade() const { return hasAttribute(MonsterAttribute::Shade); }
+        bool isXerician() const { return hasAttribute(MonsterAttribute::Xerician); }
+        bool isUndead() const { return hasAttribute(MonsterAttribute::Undead); }
 };
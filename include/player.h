@@ -2,13 +2,36 @@
 #pragma once
 #include <string>
 #include <map>
+#include <functional>
+#include <memory>
 #include "item.h"
+#include "item_arena.h"
+#include "loadout.h"
+
+class BinaryDb;
+
+// Hiscores order, which is also the order of the stats CSV lines
+enum class Skill {
+    Overall, Attack, Defence, Strength, Hitpoints, Ranged,
+    Prayer, Magic, Cooking, Woodcutting, Fletching, Fishing,
+    Firemaking, Crafting, Smithing, Mining, Herblore, Agility,
+    Thieving, Slayer, Farming, Runecraft, Hunter, Construction
+};
+constexpr int kSkillCount = 24;
+
+// Display name of a skill ("Attack"), and the skill of a name (-1 if none)
+const char* skillName(Skill skill);
+int skillIndex(const std::string& name);
 
 class Player {
 private:
     std::string username;
-    std::map<std::string, int> stats_;
-    std::map<std::string, Item> gear_; // Stores equipped items by slot (e.g., "head", "body")
+    int levels_[kSkillCount];               // Base levels by Skill
+    int boosted_[kSkillCount];              // levels_ plus potion boosts
+    const Item* gear_[kGearSlotCount] {};      // Equipped item per GearSlot
+    std::shared_ptr<const Item> owned_[kGearSlotCount]; // Hand-built items in gear_, held by value
+    int gearBonus_[kItemStatCount] {};          // Stats summed over gear_
+    GearSetTracker gearSets_;                   // Set pieces worn in gear_
     
     // State flags
     bool onSlayerTask_ {false};
@@ -17,51 +40,82 @@ private:
     bool superCombat_ {false};
     int currentHP_ {99};
     int maxHP_ {99};
+    uint64_t fingerprint_ {0};              // Zobrist XOR over everything above
+
+    void updateBoosts(); // Recomputes boosted_ from levels_ and potions
+    void setFlag(bool& flag, int index, bool active);
+    void wear(GearSlot slot, const Item* item, std::shared_ptr<const Item> owned);
+#ifndef __EMSCRIPTEN__
+    // Equips the WikiSync loadout into empty slots, each item by ID with equipById
+    void loadWikiSyncGear(const std::function<void(GearSlot, int)>& equipById);
+#endif
 
 public:
     Player(std::string n = "");
     void parseStats(std::string csv_str);
-    int getStat(const std::string& skill) { return stats_[skill]; }
-    void setStat(const std::string& skill, int level) { stats_[skill] = level; }
+    int getStat(Skill skill) const { return levels_[static_cast<int>(skill)]; }
+    void setStat(Skill skill, int level);
+    // By skill name; unknown names read 0 and are not stored
+    int getStat(const std::string& skill) const;
+    void setStat(const std::string& skill, int level);
     
     // Prayers & Potions
-    void setPiety(bool active) { piety_ = active; }
+    void setPiety(bool active) { setFlag(piety_, 0, active); }
     bool isPietyActive() const { return piety_; }
-    void setRigour(bool active) { rigour_ = active; }
+    void setRigour(bool active) { setFlag(rigour_, 1, active); }
     bool isRigourActive() const { return rigour_; }
-    void setSuperCombat(bool active) { superCombat_ = active; }
+    void setSuperCombat(bool active);
     bool isSuperCombatActive() const { return superCombat_; }
     
-    // Helper to get level including potion boosts
-    int getBoostedLevel(const std::string& skill);
+    // Level including potion boosts, kept up to date by the setters.
+    // Prayers scale accuracy and strength differently, so BattleProfile
+    // applies them.
+    int getBoostedLevel(Skill skill) const { return boosted_[static_cast<int>(skill)]; }
+    int getBoostedLevel(const std::string& skill) const;
+
+    // Zobrist fingerprint of gear, levels, prayers, potions, task and HP,
+    // updated by every setter; equal combat states give equal values
+    uint64_t fingerprint() const { return fingerprint_; }
 
     std::string getUsername() const { return username; }
     void setUsername(const std::string& name) { username = name; }
     
     // Gear management
+    void equip(GearSlot slot, const Item& item); // Hand-built item, copied once
+    // Item of a loaded database, shared rather than copied; the arena must
+    // outlive the player and its copies
+    void equip(GearSlot slot, const ItemArena& items, ItemHandle item);
+    void unequip(GearSlot slot);
+    void clearGear();
+    // Item in a slot, nullptr when empty; valid until the slot changes.
+    // Copies of the player share their items.
+    const Item* getItem(GearSlot slot) const { return gear_[static_cast<int>(slot)]; }
+    
+    // Slot-name adapters for WASM and JSON ("2h" is the weapon slot);
+    // unknown slot names are ignored
     void equip(const std::string& slot, const Item& item);
     void unequip(const std::string& slot);
-    void clearGear() { gear_.clear(); }
-    bool hasItem(const std::string& slot) const { return gear_.count(slot) > 0; }
+    bool hasItem(const std::string& slot) const;
     Item getEquippedItem(const std::string& slot) const;
     bool hasEquipped(const std::string& itemName) const;
     
     // Combat
-    int getEffectiveStat(const std::string& stat); // Base stat + gear bonuses
-    int getEquipmentBonus(const std::string& bonus); // Sum of gear bonuses
-    const std::map<std::string, Item>& getGear() const { return gear_; }
+    int getEffectiveStat(const std::string& stat) const; // Base stat + gear bonuses
+    int getEquipmentBonus(const std::string& bonus) const; // Sum of gear bonuses
+    int getEquipmentBonus(ItemStat stat) const { return gearBonus_[static_cast<int>(stat)]; }
+    Loadout getLoadout() const; // View of the equipped items, valid until gear changes
     
     // State Management
-    void setSlayerTask(bool onTask) { onSlayerTask_ = onTask; }
+    void setSlayerTask(bool onTask) { setFlag(onSlayerTask_, 3, onTask); }
     bool isOnSlayerTask() const { return onSlayerTask_; }
     
-    void setHP(int current, int max) { currentHP_ = current; maxHP_ = max; }
+    void setHP(int current, int max);
     int getCurrentHP() const { return currentHP_; }
     int getMaxHP() const { return maxHP_; }
     
     // Set Bonus Helper
-    std::string getActiveSet();
-    int countCrystalPieces();
+    std::string getActiveSet() const;
+    int countCrystalPieces() const;
     
 #ifndef __EMSCRIPTEN__
     // Network methods - only available in native builds
@@ -69,6 +123,7 @@ public:
     void fetchGearFromClient();
     void loadGearStats(const std::string& itemDbPath);
     void loadGearStats(const json& itemDb);
+    void loadGearStats(const BinaryDb& db);
 #endif
 };
 
@@ -0,0 +1,165 @@
+#pragma once
+#include <cstdint>
+
+// SplitMix64: used to seed the simulation generators and to derive
+// statistically independent stream seeds from one master seed.
+struct SplitMix64 {
+    uint64_t state;
+
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+// Seed of the index-th stream under a master seed
+inline uint64_t streamSeed(uint64_t seed, uint64_t index) {
+    SplitMix64 inner(index);
+    SplitMix64 outer(seed ^ inner.next());
+    return outer.next();
+}
+
+// All engines below are UniformRandomBitGenerators producing 64 bits per call
+// and are seeded from a single 64-bit value through SplitMix64.
+
+// xoshiro256** (Blackman & Vigna)
+class Xoshiro256ss {
+    private:
+        uint64_t s_[4];
+
+        static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    public:
+        using result_type = uint64_t;
+        static constexpr const char* name = "xoshiro256**";
+
+        explicit Xoshiro256ss(uint64_t seed = 0) { this->seed(seed); }
+
+        void seed(uint64_t seed) {
+            SplitMix64 sm(seed);
+            for (auto& s : s_) s = sm.next();
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~0ull; }
+
+        result_type operator()() {
+            uint64_t result = rotl(s_[1] * 5, 7) * 9;
+            uint64_t t = s_[1] << 17;
+            s_[2] ^= s_[0];
+            s_[3] ^= s_[1];
+            s_[1] ^= s_[2];
+            s_[0] ^= s_[3];
+            s_[2] ^= t;
+            s_[3] = rotl(s_[3], 45);
+            return result;
+        }
+};
+
+// PCG64 (128-bit LCG with XSL-RR output)
+class Pcg64 {
+    private:
+        __uint128_t state_ {0};
+        __uint128_t inc_ {1};
+
+        static constexpr __uint128_t multiplier() {
+            return (static_cast<__uint128_t>(0x2360ED051FC65DA4ull) << 64) | 0x4385DF649FCCF645ull;
+        }
+
+    public:
+        using result_type = uint64_t;
+        static constexpr const char* name = "pcg64";
+
+        explicit Pcg64(uint64_t seed = 0) { this->seed(seed); }
+
+        void seed(uint64_t seed) {
+            SplitMix64 sm(seed);
+            uint64_t s0 = sm.next(), s1 = sm.next(), i0 = sm.next(), i1 = sm.next();
+            inc_ = (((static_cast<__uint128_t>(i0) << 64) | i1) << 1) | 1u;
+            state_ = 0;
+            (*this)();
+            state_ += (static_cast<__uint128_t>(s0) << 64) | s1;
+            (*this)();
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~0ull; }
+
+        result_type operator()() {
+            state_ = state_ * multiplier() + inc_;
+            uint64_t x = static_cast<uint64_t>(state_ >> 64) ^ static_cast<uint64_t>(state_);
+            unsigned rot = static_cast<unsigned>(state_ >> 122);
+            return (x >> rot) | (x << ((64 - rot) & 63));
+        }
+};
+
+// Philox4x32-10 (Salmon et al.), a counter-based generator: output block n is
+// a pure function of (key, n), so streams can be split without any state.
+class Philox4x32 {
+    private:
+        uint32_t key_[2] {0, 0};
+        uint32_t ctr_[4] {0, 0, 0, 0};
+        uint32_t out_[4] {0, 0, 0, 0};
+        int used_ {4};
+
+        void refill() {
+            uint32_t c[4] = {ctr_[0], ctr_[1], ctr_[2], ctr_[3]};
+            uint32_t k0 = key_[0], k1 = key_[1];
+            for (int r = 0; r < 10; ++r) {
+                uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c[0];
+                uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c[2];
+                uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0;
+                uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1;
+                c[0] = n0;
+                c[1] = static_cast<uint32_t>(p1);
+                c[2] = n2;
+                c[3] = static_cast<uint32_t>(p0);
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            for (int i = 0; i < 4; ++i) out_[i] = c[i];
+            for (int i = 0; i < 4 && ++ctr_[i] == 0; ++i) {}
+            used_ = 0;
+        }
+
+    public:
+        using result_type = uint64_t;
+        static constexpr const char* name = "philox4x32-10";
+
+        explicit Philox4x32(uint64_t seed = 0) { this->seed(seed); }
+
+        void seed(uint64_t seed) {
+            uint64_t k = SplitMix64(seed).next();
+            key_[0] = static_cast<uint32_t>(k);
+            key_[1] = static_cast<uint32_t>(k >> 32);
+            ctr_[0] = ctr_[1] = ctr_[2] = ctr_[3] = 0;
+            used_ = 4;
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~0ull; }
+
+        result_type operator()() {
+            if (used_ >= 4) refill();
+            uint64_t lo = out_[used_++];
+            uint64_t hi = out_[used_++];
+            return (hi << 32) | lo;
+        }
+};
+
+// Engine of Battle's own generator; pick another at build time with
+// -DOSRS_RNG_PCG64 or -DOSRS_RNG_PHILOX. It drives single-fight simulate()
+// and the seeds runSimulations(n) draws. The batched kernels behind every
+// runSimulations* overload always use per-lane xoshiro128** (kSimRngName,
+// which run manifests record), so the flag does not change their results.
+#if defined(OSRS_RNG_PCG64)
+using BattleRng = Pcg64;
+#elif defined(OSRS_RNG_PHILOX)
+using BattleRng = Philox4x32;
+#else
+using BattleRng = Xoshiro256ss;
+#endif
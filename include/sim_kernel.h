@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include "ttk_sketch.h"
+
+// Monte Carlo fight kernels: a scalar single fight on any RNG engine, and a
+// batched kernel that advances kSimLanes fights in lockstep, one attack per
+// step, with finished lanes masked out.
+
+constexpr int kSimLanes = 8;
+
+// Per-lane engine of the batched kernels, recorded in run manifests. Fixed:
+// BattleRng (rng.h) does not change it.
+constexpr const char* kSimRngName = "xoshiro128**";
+
+enum class SimBackend { Auto, Scalar, SSE2, AVX2 };
+
+// One attack as an alias table over its damage (see DamageTable)
+struct SimAttackParams {
+    int32_t hp;
+    int32_t columns;         // Possible damage values 0..columns-1
+    const uint32_t* accept;  // Per-column acceptance threshold scaled to 2^24
+    const uint32_t* alias;   // Damage used when the column is rejected
+};
+
+// Aggregate of finished fights; plain sums, so chunks can be merged in any
+// order and still give identical results
+struct SimStats {
+    uint64_t fights {0};
+    uint64_t attacks {0};
+    uint64_t attacksSq {0}; // Sum of squared attack counts, for the variance
+
+    void add(uint32_t fightAttacks) {
+        ++fights;
+        attacks += fightAttacks;
+        attacksSq += static_cast<uint64_t>(fightAttacks) * fightAttacks;
+    }
+    void merge(const SimStats& other) {
+        fights += other.fights;
+        attacks += other.attacks;
+        attacksSq += other.attacksSq;
+    }
+
+    double meanAttacks() const { return fights ? static_cast<double>(attacks) / fights : 0.0; }
+    // Unbiased sample variance of the attacks per fight
+    double varianceAttacks() const {
+        if (fights < 2) return 0.0;
+        double mean = meanAttacks();
+        return (static_cast<double>(attacksSq) - mean * static_cast<double>(attacks)) / (fights - 1);
+    }
+};
+
+// Sums over antithetic fight pairs (see simulatePairsBatched). For pair j,
+// Kp_j is the attacks of both fights and Op_j their total overkill, so the
+// damage dealt by the pair is 2 * hp + Op_j.
+struct PairedSimStats {
+    uint64_t pairs {0};
+    uint64_t fightAttacksSq {0};   // Sum of K^2 over single fights
+    uint64_t attacks {0};          // Sum of Kp
+    uint64_t attacksSq {0};        // Sum of Kp^2
+    uint64_t overkill {0};         // Sum of Op
+    uint64_t overkillSq {0};       // Sum of Op^2
+    uint64_t cross {0};            // Sum of Kp * Op
+
+    void merge(const PairedSimStats& other) {
+        pairs += other.pairs;
+        fightAttacksSq += other.fightAttacksSq;
+        attacks += other.attacks;
+        attacksSq += other.attacksSq;
+        overkill += other.overkill;
+        overkillSq += other.overkillSq;
+        cross += other.cross;
+    }
+};
+
+// One fight on any 64-bit engine; returns the number of attacks made.
+// Each attack is one engine call: the low 32 bits pick an alias column and
+// the top 24 bits accept it or take its alias.
+template <class Rng>
+uint32_t simulateFight(Rng& rng, const SimAttackParams& p) {
+    int32_t hp = p.hp;
+    uint32_t attacks = 0;
+
+    while (hp > 0) {
+        ++attacks;
+        uint64_t u = rng();
+        uint32_t col = static_cast<uint32_t>(((u & 0xFFFFFFFFull) * static_cast<uint32_t>(p.columns)) >> 32);
+        hp -= static_cast<int32_t>(static_cast<uint32_t>(u >> 40) < p.accept[col] ? col : p.alias[col]);
+    }
+    return attacks;
+}
+
+// Simulates `fights` fights and returns their attack counts, adding each
+// fight to `sketch` if given. Every backend produces identical results for
+// the same seed. The attack must be able to deal damage, otherwise no fight
+// ever ends.
+SimStats simulateFightsBatched(const SimAttackParams& params, uint64_t seed, int fights,
+                               SimBackend backend = SimBackend::Auto, TTKSketch* sketch = nullptr);
+
+// Simulates `pairs` antithetic fight pairs: the second fight of a pair uses
+// the complement of every uniform drawn by the first. Same determinism
+// guarantees as simulateFightsBatched.
+PairedSimStats simulatePairsBatched(const SimAttackParams& params, uint64_t seed, int pairs,
+                                    SimBackend backend = SimBackend::Auto);
+
+bool simBackendAvailable(SimBackend backend);
+const char* simBackendName(SimBackend backend);
@@ -0,0 +1,432 @@
+// sim_lanes.h
+// Lane backends and the lockstep fight loop shared by the batched kernels.
+// Included only by sim_kernel*.cpp so each backend can be built with its
+// own instruction set flags. The lane code has internal linkage so code
+// compiled with -mavx2 can never be picked by the linker for another TU;
+// functions it calls from other headers (TTKSketch::add) must therefore be
+// defined out of line, since an inline one would be emitted here as well.
+#pragma once
+#include "sim_kernel.h"
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace simlanes {
+
+// Starting xoshiro128** state and fight quota of every lane
+struct LaneSeeds {
+    uint32_t s[4][kSimLanes];
+    uint32_t quota[kSimLanes];
+};
+
+namespace {
+
+// Reference implementation; the vector backends must match it bit for bit.
+struct ScalarLanes {
+    struct reg { uint32_t v[kSimLanes]; };
+
+    static reg set1(uint32_t x) { reg r; for (int i = 0; i < kSimLanes; ++i) r.v[i] = x; return r; }
+    static reg load(const uint32_t* p) { reg r; for (int i = 0; i < kSimLanes; ++i) r.v[i] = p[i]; return r; }
+    static void store(uint32_t* p, reg a) { for (int i = 0; i < kSimLanes; ++i) p[i] = a.v[i]; }
+
+    static reg add(reg a, reg b) { for (int i = 0; i < kSimLanes; ++i) a.v[i] += b.v[i]; return a; }
+    static reg sub(reg a, reg b) { for (int i = 0; i < kSimLanes; ++i) a.v[i] -= b.v[i]; return a; }
+    static reg bxor(reg a, reg b) { for (int i = 0; i < kSimLanes; ++i) a.v[i] ^= b.v[i]; return a; }
+    static reg bor(reg a, reg b) { for (int i = 0; i < kSimLanes; ++i) a.v[i] |= b.v[i]; return a; }
+    static reg band(reg a, reg b) { for (int i = 0; i < kSimLanes; ++i) a.v[i] &= b.v[i]; return a; }
+    static reg andnot(reg a, reg b) { for (int i = 0; i < kSimLanes; ++i) a.v[i] = ~a.v[i] & b.v[i]; return a; }
+    template <int K> static reg shl(reg a) { for (int i = 0; i < kSimLanes; ++i) a.v[i] <<= K; return a; }
+    template <int K> static reg shr(reg a) { for (int i = 0; i < kSimLanes; ++i) a.v[i] >>= K; return a; }
+
+    // Signed compare, all-ones where a > b
+    static reg cmpgt(reg a, reg b) {
+        for (int i = 0; i < kSimLanes; ++i) {
+            a.v[i] = static_cast<int32_t>(a.v[i]) > static_cast<int32_t>(b.v[i]) ? 0xFFFFFFFFu : 0u;
+        }
+        return a;
+    }
+    // mask ? a : b
+    static reg blend(reg mask, reg a, reg b) { return bor(band(mask, a), andnot(mask, b)); }
+    // Full 64-bit a * b, split into low and high words
+    static void mulWide(reg a, reg b, reg& lo, reg& hi) {
+        for (int i = 0; i < kSimLanes; ++i) {
+            uint64_t prod = static_cast<uint64_t>(a.v[i]) * b.v[i];
+            lo.v[i] = static_cast<uint32_t>(prod);
+            hi.v[i] = static_cast<uint32_t>(prod >> 32);
+        }
+    }
+
+    // trunc(float(x) * scale) for 0 <= x < 2^24
+    static reg mulTrunc(reg x, float scale) {
+        for (int i = 0; i < kSimLanes; ++i) {
+            x.v[i] = static_cast<uint32_t>(static_cast<int32_t>(static_cast<float>(static_cast<int32_t>(x.v[i])) * scale));
+        }
+        return x;
+    }
+    static reg gather(const uint32_t* base, reg idx) {
+        for (int i = 0; i < kSimLanes; ++i) idx.v[i] = base[idx.v[i]];
+        return idx;
+    }
+    // Lanes 0-3 exchanged with lanes 4-7
+    static reg swapHalves(reg a) {
+        reg r;
+        for (int i = 0; i < kSimLanes; ++i) r.v[i] = a.v[(i + kSimLanes / 2) % kSimLanes];
+        return r;
+    }
+    static bool any(reg mask) {
+        uint32_t acc = 0;
+        for (int i = 0; i < kSimLanes; ++i) acc |= mask.v[i];
+        return acc != 0;
+    }
+    // Writes the lanes selected by mask to out[0..n) in lane order and
+    // returns n; out must have room for kSimLanes values
+    static int compress(uint32_t* out, reg a, reg mask) {
+        int n = 0;
+        for (int i = 0; i < kSimLanes; ++i) {
+            out[n] = a.v[i];
+            n += mask.v[i] & 1;
+        }
+        return n;
+    }
+};
+
+#if defined(__SSE2__)
+// Eight lanes as two SSE2 registers
+struct SSE2Lanes {
+    struct reg { __m128i lo, hi; };
+
+    static reg set1(uint32_t x) { __m128i v = _mm_set1_epi32(static_cast<int32_t>(x)); return {v, v}; }
+    static reg load(const uint32_t* p) {
+        return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4))};
+    }
+    static void store(uint32_t* p, reg a) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a.lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 4), a.hi);
+    }
+
+    static reg add(reg a, reg b) { return {_mm_add_epi32(a.lo, b.lo), _mm_add_epi32(a.hi, b.hi)}; }
+    static reg sub(reg a, reg b) { return {_mm_sub_epi32(a.lo, b.lo), _mm_sub_epi32(a.hi, b.hi)}; }
+    static reg bxor(reg a, reg b) { return {_mm_xor_si128(a.lo, b.lo), _mm_xor_si128(a.hi, b.hi)}; }
+    static reg bor(reg a, reg b) { return {_mm_or_si128(a.lo, b.lo), _mm_or_si128(a.hi, b.hi)}; }
+    static reg band(reg a, reg b) { return {_mm_and_si128(a.lo, b.lo), _mm_and_si128(a.hi, b.hi)}; }
+    static reg andnot(reg a, reg b) { return {_mm_andnot_si128(a.lo, b.lo), _mm_andnot_si128(a.hi, b.hi)}; }
+    template <int K> static reg shl(reg a) { return {_mm_slli_epi32(a.lo, K), _mm_slli_epi32(a.hi, K)}; }
+    template <int K> static reg shr(reg a) { return {_mm_srli_epi32(a.lo, K), _mm_srli_epi32(a.hi, K)}; }
+
+    static reg cmpgt(reg a, reg b) { return {_mm_cmpgt_epi32(a.lo, b.lo), _mm_cmpgt_epi32(a.hi, b.hi)}; }
+    static reg blend(reg mask, reg a, reg b) { return bor(band(mask, a), andnot(mask, b)); }
+    static void mulWide(reg a, reg b, reg& lo, reg& hi) {
+        mulWide4(a.lo, b.lo, lo.lo, hi.lo);
+        mulWide4(a.hi, b.hi, lo.hi, hi.hi);
+    }
+    // Multiply even and odd lanes to 64 bits, then interleave each word
+    static void mulWide4(__m128i a, __m128i b, __m128i& lo, __m128i& hi) {
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)),
+                                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+    }
+
+    static reg mulTrunc(reg x, float scale) {
+        __m128 s = _mm_set1_ps(scale);
+        return {_mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(x.lo), s)),
+                _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(x.hi), s))};
+    }
+    static reg gather(const uint32_t* base, reg idx) {
+        uint32_t lanes[kSimLanes];
+        store(lanes, idx);
+        for (int i = 0; i < kSimLanes; ++i) lanes[i] = base[lanes[i]];
+        return load(lanes);
+    }
+    static reg swapHalves(reg a) { return {a.hi, a.lo}; }
+    static bool any(reg mask) { return _mm_movemask_epi8(_mm_or_si128(mask.lo, mask.hi)) != 0; }
+    static int compress(uint32_t* out, reg a, reg mask) {
+        uint32_t lanes[kSimLanes], keep[kSimLanes];
+        store(lanes, a);
+        store(keep, mask);
+        int n = 0;
+        for (int i = 0; i < kSimLanes; ++i) {
+            out[n] = lanes[i];
+            n += keep[i] & 1;
+        }
+        return n;
+    }
+};
+#endif
+
+#if defined(__AVX2__)
+// For every 8-bit lane mask: the indices of its set lanes, one per byte,
+// and how many there are
+struct LeftPackTable {
+    uint64_t lanes[256] {};
+    uint8_t count[256] {};
+
+    constexpr LeftPackTable() {
+        for (int m = 0; m < 256; ++m) {
+            int n = 0;
+            for (int l = 0; l < kSimLanes; ++l) {
+                if ((m >> l) & 1) lanes[m] |= static_cast<uint64_t>(l) << (8 * n++);
+            }
+            count[m] = static_cast<uint8_t>(n);
+        }
+    }
+};
+
+struct AVX2Lanes {
+    using reg = __m256i;
+
+    static reg set1(uint32_t x) { return _mm256_set1_epi32(static_cast<int32_t>(x)); }
+    static reg load(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(uint32_t* p, reg a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a); }
+
+    static reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_epi32(a, b); }
+    static reg bxor(reg a, reg b) { return _mm256_xor_si256(a, b); }
+    static reg bor(reg a, reg b) { return _mm256_or_si256(a, b); }
+    static reg band(reg a, reg b) { return _mm256_and_si256(a, b); }
+    static reg andnot(reg a, reg b) { return _mm256_andnot_si256(a, b); }
+    template <int K> static reg shl(reg a) { return _mm256_slli_epi32(a, K); }
+    template <int K> static reg shr(reg a) { return _mm256_srli_epi32(a, K); }
+
+    static reg cmpgt(reg a, reg b) { return _mm256_cmpgt_epi32(a, b); }
+    static reg blend(reg mask, reg a, reg b) { return _mm256_blendv_epi8(b, a, mask); }
+    // 64-bit products of the even and odd lanes, words blended back in place
+    static void mulWide(reg a, reg b, reg& lo, reg& hi) {
+        __m256i even = _mm256_mul_epu32(a, b);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+        hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    }
+
+    static reg mulTrunc(reg x, float scale) {
+        return _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(x), _mm256_set1_ps(scale)));
+    }
+    static reg gather(const uint32_t* base, reg idx) {
+        return _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), idx, 4);
+    }
+    static reg swapHalves(reg a) { return _mm256_permute2x128_si256(a, a, 0x01); }
+    static bool any(reg mask) { return !_mm256_testz_si256(mask, mask); }
+    // Left-pack through a lane permutation looked up by the mask bits
+    static int compress(uint32_t* out, reg a, reg mask) {
+        static constexpr LeftPackTable table {};
+        int bits = _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+        __m256i perm = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(table.lanes[bits])));
+        store(out, _mm256_permutevar8x32_epi32(a, perm));
+        return table.count[bits];
+    }
+};
+#endif
+
+// xoshiro128** on every lane
+template <class L>
+struct LaneRng {
+    using R = typename L::reg;
+    R s0, s1, s2, s3;
+
+    explicit LaneRng(const LaneSeeds& seeds)
+        : s0(L::load(seeds.s[0])), s1(L::load(seeds.s[1])), s2(L::load(seeds.s[2])), s3(L::load(seeds.s[3])) {}
+
+    R next() {
+        // rotl(s1 * 5, 7) * 9
+        R x = L::add(L::template shl<2>(s1), s1);
+        x = L::bor(L::template shl<7>(x), L::template shr<25>(x));
+        R result = L::add(L::template shl<3>(x), x);
+
+        R t = L::template shl<9>(s1);
+        s2 = L::bxor(s2, s0);
+        s3 = L::bxor(s3, s1);
+        s1 = L::bxor(s1, s2);
+        s0 = L::bxor(s0, s3);
+        s2 = L::bxor(s2, t);
+        s3 = L::bor(L::template shl<11>(s3), L::template shr<21>(s3));
+        return result;
+    }
+};
+
+// Per-lane 64-bit sum kept as a hi:lo pair of 32-bit lanes
+template <class L>
+struct WideSum {
+    using R = typename L::reg;
+    R lo = L::set1(0);
+    R hi = L::set1(0);
+
+    void add(R x) {
+        const R sign = L::set1(0x80000000u);
+        lo = L::add(lo, x);
+        // Unsigned lo < x means the low word wrapped: carry into hi
+        hi = L::sub(hi, L::cmpgt(L::bxor(x, sign), L::bxor(lo, sign)));
+    }
+    // Adds the full 64-bit a * b of every lane
+    void addProduct(R a, R b) {
+        R prodLo, prodHi;
+        L::mulWide(a, b, prodLo, prodHi);
+        add(prodLo);
+        hi = L::add(hi, prodHi);
+    }
+    uint64_t total() const {
+        uint32_t l[kSimLanes], h[kSimLanes];
+        L::store(l, lo);
+        L::store(h, hi);
+        uint64_t sum = 0;
+        for (int i = 0; i < kSimLanes; ++i) sum += (static_cast<uint64_t>(h[i]) << 32) | l[i];
+        return sum;
+    }
+};
+
+// One alias-table attack per lane from two draws: a column from one 24-bit
+// uniform and the accept/alias choice from a second. Float rounding can land
+// exactly on `columns`, so the column is clamped.
+template <class L>
+typename L::reg aliasDamage(const SimAttackParams& p, typename L::reg colDraw, typename L::reg acceptDraw) {
+    using R = typename L::reg;
+    const R colTop = L::set1(static_cast<uint32_t>(p.columns - 1));
+    const float colScale = static_cast<float>(p.columns) * (1.0f / 16777216.0f);
+
+    R col = L::mulTrunc(L::template shr<8>(colDraw), colScale);
+    col = L::blend(L::cmpgt(col, colTop), colTop, col);
+    R keep = L::cmpgt(L::gather(p.accept, col), L::template shr<8>(acceptDraw));
+    return L::blend(keep, col, L::gather(p.alias, col));
+}
+
+// Lockstep fight loop. Each lane runs its quota of fights back to back with
+// its own xoshiro128** stream; a lane is masked out once its quota is done.
+// Finished fights are also added to `sketch` when one is given.
+template <class L>
+SimStats runFights(const SimAttackParams& p, const LaneSeeds& seeds, TTKSketch* sketch) {
+    using R = typename L::reg;
+
+    LaneRng<L> rng(seeds);
+    R left = L::load(seeds.quota);
+
+    const R zero = L::set1(0);
+    const R hpInit = L::set1(static_cast<uint32_t>(p.hp));
+
+    R hp = hpInit;
+    R attacks = zero;
+    WideSum<L> total;
+    WideSum<L> sq; // Sum of squared attack counts, 64-bit so long fights cannot wrap
+    R active = L::cmpgt(left, zero);
+    constexpr int kPending = 256; // Finished fights, handed to the sketch in batches
+    uint32_t pending[kPending];
+    int pendingCount = 0;
+
+    while (L::any(active)) {
+        attacks = L::sub(attacks, active); // Mask is -1 on active lanes
+
+        R colDraw = rng.next();
+        R dmg = aliasDamage<L>(p, colDraw, rng.next());
+        hp = L::sub(hp, L::band(active, dmg));
+
+        R done = L::andnot(L::cmpgt(hp, zero), active);
+        if (sketch) {
+            pendingCount += L::compress(pending + pendingCount, attacks, done);
+            if (pendingCount > kPending - kSimLanes) {
+                sketch->add(pending, pendingCount);
+                pendingCount = 0;
+            }
+        }
+        R finishedAttacks = L::band(done, attacks);
+        total.add(finishedAttacks);
+        sq.addProduct(finishedAttacks, attacks);
+        left = L::add(left, done);
+        hp = L::blend(done, hpInit, hp);
+        attacks = L::andnot(done, attacks);
+        active = L::cmpgt(left, zero);
+    }
+
+    if (sketch) sketch->add(pending, pendingCount);
+
+    SimStats stats;
+    for (int l = 0; l < kSimLanes; ++l) stats.fights += seeds.quota[l];
+    stats.attacks = total.total();
+    stats.attacksSq = sq.total();
+    return stats;
+}
+
+// Antithetic pairs: lane l + 4 replays lane l's fight with every uniform
+// complemented (u -> 1 - u), starting together. A lane that finishes first
+// waits for its partner, then the pair is recorded and both restart. Only
+// lanes 0-3 record pair sums; quotas are in pairs and mirrored in lanes 4-7.
+template <class L>
+PairedSimStats runPairedFights(const SimAttackParams& p, const LaneSeeds& seeds) {
+    using R = typename L::reg;
+
+    LaneRng<L> rng(seeds);
+    R left = L::load(seeds.quota);
+
+    const R zero = L::set1(0);
+    const R ones = L::set1(0xFFFFFFFFu);
+    const R hpInit = L::set1(static_cast<uint32_t>(p.hp));
+    uint32_t upperInit[kSimLanes];
+    for (int l = 0; l < kSimLanes; ++l) upperInit[l] = l >= kSimLanes / 2 ? 0xFFFFFFFFu : 0u;
+    const R upper = L::load(upperInit);
+
+    auto draw = [&]() {
+        R x = rng.next();
+        return L::blend(upper, L::bxor(L::swapHalves(x), ones), x);
+    };
+
+    R hp = hpInit;
+    R attacks = zero;
+    R running = L::cmpgt(left, zero);
+
+    // 64-bit per lane: a pair of long fights alone passes 2^16 attacks
+    WideSum<L> pairAttacks;     // Sum over pairs of K_a + K_b
+    WideSum<L> pairOverkill;    // Sum over pairs of O_a + O_b
+    WideSum<L> pairOverkillSq;
+    WideSum<L> fightAttacksSq;  // Sum over single fights of K^2
+    WideSum<L> pairAttacksSq;
+    WideSum<L> pairCross;       // Sum over pairs of (K_a + K_b)(O_a + O_b)
+
+    while (L::any(running)) {
+        R fighting = L::band(running, L::cmpgt(hp, zero));
+        attacks = L::sub(attacks, fighting);
+
+        R colDraw = draw();
+        R dmg = aliasDamage<L>(p, colDraw, draw());
+        hp = L::sub(hp, L::band(fighting, dmg));
+
+        R finished = L::andnot(L::cmpgt(hp, zero), running);
+        R pairDone = L::band(finished, L::swapHalves(finished));
+        R record = L::andnot(upper, pairDone);
+
+        R overkill = L::sub(zero, hp);
+        R kp = L::add(attacks, L::swapHalves(attacks));
+        R op = L::add(overkill, L::swapHalves(overkill));
+
+        R recordKp = L::band(record, kp);
+        R recordOp = L::band(record, op);
+        fightAttacksSq.addProduct(L::band(pairDone, attacks), attacks);
+        pairAttacks.add(recordKp);
+        pairOverkill.add(recordOp);
+        pairOverkillSq.addProduct(recordOp, op);
+        pairAttacksSq.addProduct(recordKp, kp);
+        pairCross.addProduct(recordKp, op);
+
+        left = L::add(left, pairDone);
+        hp = L::blend(pairDone, hpInit, hp);
+        attacks = L::andnot(pairDone, attacks);
+        running = L::cmpgt(left, zero);
+    }
+
+    PairedSimStats stats;
+    for (int l = 0; l < kSimLanes / 2; ++l) stats.pairs += seeds.quota[l];
+    stats.fightAttacksSq = fightAttacksSq.total();
+    stats.attacks = pairAttacks.total();
+    stats.attacksSq = pairAttacksSq.total();
+    stats.overkill = pairOverkill.total();
+    stats.overkillSq = pairOverkillSq.total();
+    stats.cross = pairCross.total();
+    return stats;
+}
+
+} // namespace
+} // namespace simlanes
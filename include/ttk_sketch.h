@@ -0,0 +1,49 @@
+// ttk_sketch.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Compact fixed-width histogram of kill times, ready for display
+struct TTKHistogram {
+    int startTicks {0};             // Lower edge of the first bucket
+    int bucketTicks {0};            // Width of every bucket
+    std::vector<uint64_t> counts;   // Last bucket also holds the far tail
+};
+
+// Streaming distribution of attacks per fight in fixed memory. Counts are
+// exact below kExactAttacks attacks and in log buckets 2% wide above, so
+// quantiles are exact for ordinary fights and within 1% for very long ones.
+// Two sketches merge by adding counts: the result does not depend on how
+// the fights were split between threads or in which order they merged.
+class TTKSketch {
+    public:
+        static constexpr int kExactAttacks = 1024;
+        static constexpr int kLogBins = 800;    // Covers every 32-bit count
+        static constexpr int kBins = kExactAttacks + kLogBins;
+
+    private:
+        uint64_t counts_[kBins] {};
+        uint64_t fights_ {0};
+        uint32_t min_ {0xFFFFFFFFu};
+        uint32_t max_ {0};
+
+        static int logBin(uint32_t attacks);
+        static double binValue(int bin); // Representative attack count
+
+    public:
+        // Out of line so the AVX2 kernel never emits a copy (see sim_lanes.h)
+        void add(uint32_t attacks);
+        void add(const uint32_t* attacks, int count);
+        void merge(const TTKSketch& other);
+
+        uint64_t fights() const { return fights_; }
+        uint32_t minAttacks() const { return fights_ ? min_ : 0; }
+        uint32_t maxAttacks() const { return max_; }
+
+        // Smallest attack count reached by at least a fraction q of fights
+        double quantileAttacks(double q) const;
+
+        // At most maxBuckets buckets in ticks from the shortest fight up to
+        // the 99.9th percentile; longer fights go in the last bucket
+        TTKHistogram histogram(int attackSpeed, int maxBuckets = 32) const;
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include "player.h"
 #include "monster.h"
+#include "binary_db.h"
 #include "json.hpp"
 #include <vector>
 #include <string>
@@ -27,16 +28,23 @@ class UpgradeAdvisor {
 private:
     Player& player_;
     Monster& monster_;
-    const json& itemDb_;
-    const json& priceDb_;
+    // Either the JSON databases or a compiled BinaryDb
+    const json* itemDb_ {nullptr};
+    const json* priceDb_ {nullptr};
+    const BinaryDb* db_ {nullptr};
     std::map<int, int> priceProxies_;
     std::map<int, int> fixedPriceProxies_;
 
     // Helper to check if item is a potential upgrade
     bool isPotentialUpgrade(const Item& candidate, const Item& current);
+    // Mid price in GP after the proxies, 0 if the item has no price
+    int marketPrice(int id) const;
+
+    UpgradeAdvisor(Player& p, Monster& m);
 
 public:
     UpgradeAdvisor(Player& p, Monster& m, const json& items, const json& prices);
+    UpgradeAdvisor(Player& p, Monster& m, const BinaryDb& db);
     
     std::vector<UpgradeSuggestion> suggestUpgrades();
 };
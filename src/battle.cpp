@@ -1,11 +1,195 @@
 // battle.cpp
 #include "battle.h"
+#include "rng.h"
+#include "sim_kernel.h"
+#include "fingerprint.h"
 #include <iostream>
 #include <numeric>
 #include <vector>
 #include <iomanip>
+#include <limits>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <cstdio>
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+// Fights per independently seeded RNG stream in runSimulations
+constexpr int kSimChunkSize = 1024;
+
+// Smaller streams for adaptive runs, so easy scenarios can stop early
+constexpr int kAdaptiveChunkSize = 256;
+
+// z for a two-sided 95% confidence interval
+constexpr double kZ95 = 1.959963984540054;
+
+// Multiply-adds solveTTK may spend stepping the alive-HP distribution
+// before it fits the remaining percentiles instead (a few milliseconds)
+constexpr long long kTTKStepBudget = 1LL << 22;
+
+// Standard normal quantiles of the p50, p90 and p99 kill times
+constexpr double kTTKQuantileZ[3] = {0.0, 1.2815515655446004, 2.3263478740408408};
+
+// Fight totals together with their distribution
+struct SimRun {
+    SimStats stats;
+    TTKSketch sketch;
+    
+    void merge(const SimRun& other) {
+        stats.merge(other.stats);
+        sketch.merge(other.sketch);
+    }
+};
+
+// Runs work units [first, first + count) where unit i belongs to the RNG
+// stream streamSeed(seed, i / chunkSize); `run(streamSeed, units, stats)`
+// simulates one chunk into the running worker's stats. `first` must be a
+// multiple of chunkSize. Chunks are handed out to the threads through an
+// atomic counter. Stats are integer sums, so the per-worker totals merge to
+// the same result whatever the split, and memory does not grow with n.
+template <class Stats, class Run>
+Stats simulateChunks(Run run, uint64_t seed, int chunkSize, int first, int count, int threads) {
+    int firstChunk = first / chunkSize;
+    int chunks = (count + chunkSize - 1) / chunkSize;
+    std::atomic<int> nextChunk {0};
+    
+    auto worker = [&](Stats& stats) {
+        for (int c = nextChunk++; c < chunks; c = nextChunk++) {
+            int begin = c * chunkSize;
+            int units = std::min(count, begin + chunkSize) - begin;
+            run(streamSeed(seed, firstChunk + c), units, stats);
+        }
+    };
+    
+#ifdef __EMSCRIPTEN__
+    threads = 1;
+#else
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+#endif
+    threads = std::max(1, std::min(threads, chunks));
+    
+    std::vector<Stats> workerStats(threads);
+    if (threads == 1) {
+        worker(workerStats[0]);
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(threads);
+        for (int t = 0; t < threads; ++t) pool.emplace_back(worker, std::ref(workerStats[t]));
+        for (auto& th : pool) th.join();
+    }
+    
+    Stats total;
+    for (const Stats& s : workerStats) total.merge(s);
+    return total;
+}
+
+SimulationEstimate estimate(const SimStats& stats, int speed) {
+    SimulationEstimate est {0.0, 0.0, 0.0, static_cast<int>(stats.fights), true, 1.0};
+    if (stats.fights == 0) return est;
+    est.meanTicks = stats.meanAttacks() * speed;
+    est.stdErrorTicks = std::sqrt(stats.varianceAttacks() / stats.fights) * speed;
+    est.ciHalfWidthTicks = kZ95 * est.stdErrorTicks;
+    return est;
+}
+
+// Control-variate estimate from antithetic pairs. Per pair, Y is the mean
+// attacks of its two fights and X = D / 2 - mu * Y, where D is the damage
+// dealt (2 * hp plus overkill) and mu the mean damage per attack. Wald's
+// identity gives E[D] = mu * E[attacks], so E[X] = 0 and Y - beta * X is
+// unbiased for every beta; the variance-minimising beta is estimated from
+// the same pairs.
+SimulationEstimate estimate(const PairedSimStats& stats, int speed, int hp, double mu) {
+    double n = static_cast<double>(stats.pairs);
+    SimulationEstimate est {0.0, 0.0, 0.0, static_cast<int>(2 * stats.pairs), true, 1.0};
+    if (stats.pairs < 2) {
+        if (stats.pairs) est.meanTicks = stats.attacks / (2.0 * n) * speed;
+        return est;
+    }
+    
+    double sk = static_cast<double>(stats.attacks);
+    double so = static_cast<double>(stats.overkill);
+    double varK = (static_cast<double>(stats.attacksSq) - sk * sk / n) / (n - 1);
+    double varO = (static_cast<double>(stats.overkillSq) - so * so / n) / (n - 1);
+    double covKO = (static_cast<double>(stats.cross) - sk * so / n) / (n - 1);
+    
+    // Y = Kp / 2, X = hp + (Op - mu * Kp) / 2
+    double meanY = sk / (2.0 * n);
+    double meanX = hp + (so - mu * sk) / (2.0 * n);
+    double varY = varK / 4.0;
+    double varX = (varO - 2.0 * mu * covKO + mu * mu * varK) / 4.0;
+    double covXY = (covKO - mu * varK) / 4.0;
+    
+    double beta = varX > 0.0 ? covXY / varX : 0.0;
+    double varCV = std::max(0.0, varY - beta * covXY);
+    
+    // What plain sampling of the same number of independent fights gives
+    double fights = 2.0 * n;
+    double varPlain = (static_cast<double>(stats.fightAttacksSq) - sk * sk / fights) / (fights - 1);
+    
+    est.meanTicks = (meanY - beta * meanX) * speed;
+    est.stdErrorTicks = std::sqrt(varCV / n) * speed;
+    est.ciHalfWidthTicks = kZ95 * est.stdErrorTicks;
+    est.varianceReduction = varCV > 0.0 ? (varPlain / fights) / (varCV / n) : 1.0;
+    return est;
+}
+
+// Distinct seed for every Battle without touching random_device each time
+uint64_t nextBattleSeed() {
+    static const uint64_t base = []() {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32) | rd();
+    }();
+    static std::atomic<uint64_t> counter {0};
+    return streamSeed(base, counter++);
+}
+
+// FNV-1a over raw bytes
+uint64_t fnv1a(uint64_t h, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+}
+
+uint64_t stateFingerprint(const Player& player, const Monster& monster) {
+    return player.fingerprint() ^ zobristKey(FingerprintFeature::Monster, 2, monster.fingerprint());
+}
+
+std::string RunManifest::toJson() const {
+    json j = {
+        {"seed", fingerprintHex(seed)},
+        {"rng", rng},
+        {"scenario", fingerprintHex(scenario)},
+        {"fights", fights},
+        {"meanTicks", meanTicks}
+    };
+    return j.dump();
+}
+
+bool RunManifest::fromJson(const std::string& text, RunManifest& out) {
+    try {
+        json j = json::parse(text);
+        RunManifest m;
+        m.seed = std::stoull(j.at("seed").get<std::string>(), nullptr, 16);
+        m.rng = j.at("rng").get<std::string>();
+        m.scenario = std::stoull(j.at("scenario").get<std::string>(), nullptr, 16);
+        m.fights = j.at("fights").get<int>();
+        m.meanTicks = j.at("meanTicks").get<double>();
+        out = m;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid run manifest: " << e.what() << "\n";
+        return false;
+    }
+}
 
 Battle::Battle(Player& p, Monster& m) : player_(p), monster_(m) {
     init();
@@ -18,679 +202,313 @@ Battle::Battle(const Player& p, const Monster& m) : player_(p), monster_(m) {
 }
 
 void Battle::init() {
-    std::random_device rd;
-    gen = std::mt19937(rd());
-    
-    // Default values
-    attack_speed_ = 4;
-    isFang_ = false;
-    isDHL_ = false;
-    isDHCB_ = false;
-    isArclight_ = false;
-    isKeris_ = false;
-    isKerisBreaching_ = false;
-    isLeafBladed_ = false;
-    isScythe_ = false;
-    isTbow_ = false;
-    isDharok_ = false;
-    
-    hasSalve_ = false;
-    hasSalveE_ = false;
-    hasSalveI_ = false;
-    hasSalveEI_ = false;
-    
-    // Monster Attributes
-    isDragon_ = monster_.isDragon();
-    isUndead_ = monster_.isUndead();
-    isDemon_ = monster_.isDemon();
-    isKalphite_ = monster_.isKalphite();
-    isLeafy_ = monster_.isLeafy();
-    isVampyre_ = monster_.isVampyre();
-    isShade_ = monster_.isShade();
-    isXerician_ = monster_.isXerician();
-    
-    // Player State
-    isOnTask_ = player_.isOnSlayerTask();
-    activeSet_ = player_.getActiveSet();
-    
-    // Parse Gear
-    auto gear = player_.getGear();
+    setSeed(nextBattleSeed());
     
-    if (gear.count("weapon")) {
-        Item weapon = gear.at("weapon");
-        int speed = weapon.getInt("attack_speed");
-        if (speed > 0) attack_speed_ = speed;
-        
-        std::string name = weapon.getName();
-        
-        if (name.find("Osmumten's fang") != std::string::npos) isFang_ = true;
-        if (name.find("Dragon hunter lance") != std::string::npos) isDHL_ = true;
-        if (name.find("Dragon hunter crossbow") != std::string::npos) isDHCB_ = true;
-        if (name.find("Arclight") != std::string::npos || name.find("Emberlight") != std::string::npos) isArclight_ = true;
-        if (name.find("Keris") != std::string::npos) {
-            isKeris_ = true;
-            if (name.find("breaching") != std::string::npos) isKerisBreaching_ = true;
-        }
-        if (name.find("Leaf-bladed") != std::string::npos) isLeafBladed_ = true;
-        if (name.find("Scythe of vitur") != std::string::npos) isScythe_ = true;
-        if (name.find("Twisted bow") != std::string::npos) isTbow_ = true;
-        
-        if (activeSet_ == "Dharok" && name.find("Dharok's greataxe") != std::string::npos) {
-            isDharok_ = true;
-        }
-    }
-    
-    if (gear.count("neck")) {
-        std::string neck = gear.at("neck").getName();
-        if (neck.find("Salve amulet") != std::string::npos) {
-            if (neck.find("(ei)") != std::string::npos) hasSalveEI_ = true;
-            else if (neck.find("(i)") != std::string::npos) hasSalveI_ = true;
-            else if (neck.find("(e)") != std::string::npos) hasSalveE_ = true;
-            else hasSalve_ = true;
-        }
-    }
+    profile_ = BattleProfile::compile(player_, monster_);
+    attack_speed_ = profile_.weaponSpeed;
+    activeSet_ = player_.getActiveSet();
 
     stance_bonus_attack_ = 3;
     stance_bonus_strength_ = 0;
+    stanceName_ = "Accurate";
+}
 
-    // Check Ammo Compatibility
-    invalid_ranged_str_ = 0;
-    invalid_ranged_att_ = 0;
-    
-    if (gear.count("ammo")) {
-        Item ammo = gear.at("ammo");
-        bool compatible = false;
-
-        if (gear.count("weapon")) {
-            Item weapon = gear.at("weapon");
-            std::string wType = weapon.getStr("weapon_type");
-            std::string wName = weapon.getName();
-            std::string aName = ammo.getName();
-            
-            auto toLower = [](std::string s) {
-                std::transform(s.begin(), s.end(), s.begin(), ::tolower);
-                return s;
-            };
-            std::string wNameL = toLower(wName);
-            std::string aNameL = toLower(aName);
-            
-            if (wType == "bow") {
-                 // Standard bows need arrows
-                 if (aNameL.find("arrow") != std::string::npos) compatible = true;
-                 // Crystal bow / BowFa (no ammo slot used for stats)
-                 if (wNameL.find("crystal bow") != std::string::npos || wNameL.find("faerdhinen") != std::string::npos) compatible = false;
-            } else if (wType == "crossbow") {
-                 if (wNameL.find("ballista") != std::string::npos) {
-                     if (aNameL.find("javelin") != std::string::npos) compatible = true;
-                 } else if (wNameL.find("karil") != std::string::npos) {
-                     if (aNameL.find("bolt rack") != std::string::npos) compatible = true;
-                 } else {
-                     if (aNameL.find("bolt") != std::string::npos) compatible = true;
-                 }
-            } else if (wType == "thrown") {
-                 // Thrown weapons ignore ammo slot stats
-                 compatible = false;
-            } else {
-                // Melee weapons don't use ammo stats
-                compatible = false; 
-            }
-        } else {
-            // No weapon, ammo equipped -> Incompatible
-            compatible = false;
-        }
-        
-        if (!compatible) {
-            invalid_ranged_str_ = ammo.getInt("ranged_strength");
-            invalid_ranged_att_ = ammo.getInt("attack_ranged");
-        }
-    }
+void Battle::setStyle(CombatStyle style) {
+    combatStyle_ = style;
+    style_ = combatStyleName(style);
 }
 
 void Battle::determineStyle() {
-    int stab = player_.getEquipmentBonus("attack_stab");
-    int slash = player_.getEquipmentBonus("attack_slash");
-    int crush = player_.getEquipmentBonus("attack_crush");
-    int range = player_.getEquipmentBonus("attack_ranged");
-    
-    // Simple heuristic: pick highest bonus
-    if (range > stab && range > slash && range > crush) {
-        style_ = "ranged";
-        isRanged_ = true;
-    } else {
-        isRanged_ = false;
-        if (stab >= slash && stab >= crush) style_ = "stab";
-        else if (slash >= stab && slash >= crush) style_ = "slash";
-        else style_ = "crush";
-    }
+    setStyle(profile_.defaultStyle());
 }
 
-int Battle::effectiveStrength() {
-    if (isRanged_) {
-        // ((Ranged + Boost) * Prayer + 8 + Style)
-        int rng = player_.getBoostedLevel("Ranged");
-        
-        // Apply Prayer (Rigour gives +23% Ranged Str)
-        if (player_.isRigourActive()) {
-            rng = static_cast<int>(rng * 1.23);
-        }
-        
-        int str = rng + 8 + stance_bonus_strength_;
-        
-        // Void Range logic if needed (usually 10% or 12.5% for Elite)
-        // I'll leave Ranged Void for now as not explicitly in conflicts.
-        return str;
-    }
-
-    // ((Strength + Boost) * Prayer + 8 + Style)
-    int str = player_.getBoostedLevel("Strength");
-    
-    // Apply Prayer (Piety gives +23% Strength)
-    if (player_.isPietyActive()) {
-        str = static_cast<int>(str * 1.23);
-    }
-    
-    // Void Melee
-    if (activeSet_ == "Void Melee" || activeSet_ == "Elite Void Melee") {
-        str = static_cast<int>(str * 1.10);
-    }
-    
-    return str + 8 + stance_bonus_strength_;
+int Battle::maxHit() const {
+    return profile_.maxHit(combatStyle_, stance_bonus_strength_);
 }
 
-int Battle::effectiveAttack() {
-    if (isRanged_) {
-        int rng = player_.getBoostedLevel("Ranged");
-        
-        // Apply Prayer (Rigour gives +20% Ranged Attack)
-        if (player_.isRigourActive()) {
-            rng = static_cast<int>(rng * 1.20);
-        }
-        
-        // Void Range could apply here too
-        return rng + 8 + stance_bonus_attack_;
-    }
-
-    int att = player_.getBoostedLevel("Attack");
-    
-    // Apply Prayer (Piety gives +20% Attack)
-    if (player_.isPietyActive()) {
-        att = static_cast<int>(att * 1.20);
-    }
-    
-    // Void Melee
-    if (activeSet_ == "Void Melee" || activeSet_ == "Elite Void Melee") {
-        att = static_cast<int>(att * 1.10);
-    }
-    
-    return att + 8 + stance_bonus_attack_;
+int Battle::attackRoll() const {
+    return profile_.attackRoll(combatStyle_, stance_bonus_attack_);
 }
 
-int Battle::maxHit() {
-    int effStr = effectiveStrength();
-    
-    if (isRanged_) {
-        // ((EffRangedStr * (RangedStrBonus + 64) + 320) / 640)
-        int equipStr = player_.getEquipmentBonus("ranged_strength") - invalid_ranged_str_;
-        int baseMax = ((effStr * (equipStr + 64) + 320) / 640);
-        
-        double multiplier = 1.0;
-        
-        // Salve Amulet (i) and (ei) boost Ranged
-        if (isUndead_) {
-            if (hasSalveEI_) multiplier *= 1.20;
-            else if (hasSalveI_) multiplier *= 1.1667;
-        }
-        
-        // Slayer Helm (i) boosts Ranged
-        if (isOnTask_) {
-            if (player_.hasEquipped("Slayer helmet (i)") ||
-                player_.hasEquipped("Black mask (i)")) {
-                 // 15% for Ranged/Magic usually
-                 multiplier *= 1.15;
-            }
-        }
-        
-        // Dragon Hunter Crossbow
-        if (isDragon_ && isDHCB_) {
-            multiplier *= 1.30;
-        }
-        
-        // Twisted Bow
-        if (isTbow_) {
-            int magic = monster_.getInt("magic_level");
-            int cap = 250; 
-            if (magic > cap) magic = cap;
-            
-            double tbowMult = 0.25 + (magic * 3 - 14) / 100.0;
-            if (tbowMult > 2.5) tbowMult = 2.5;
-            if (tbowMult < 1.0) tbowMult = 1.0; 
-            
-            multiplier *= tbowMult;
-        }
-        
-        // Crystal Armor logic would go here
-        
-        return static_cast<int>(baseMax * multiplier);
-    }
+int Battle::defenceRoll() const {
+    return profile_.defenceRoll(combatStyle_);
+}
 
-    // ((EffStr * (EquipStr + 64) + 320) / 640)
-    // Try strength_bonus, fallback to melee_strength if 0 (heuristic)
-    int equipStr = player_.getEquipmentBonus("strength_bonus");
-    if (equipStr == 0) equipStr = player_.getEquipmentBonus("melee_strength");
-    
-    int baseMax = ((effStr * (equipStr + 64) + 320) / 640);
-    
-    double multiplier = 1.0;
-    
-    // --- Slayer Helm / Black Mask ---
-    if (isOnTask_) {
-        if (player_.hasEquipped("Slayer helmet") || 
-            player_.hasEquipped("Slayer helmet (i)") ||
-            player_.hasEquipped("Black mask") || 
-            player_.hasEquipped("Black mask (i)")) {
-             multiplier *= 1.1667;
-        }
-    }
-    
-    // --- Salve Amulet (Undead) ---
-    if (isUndead_) {
-        double salveMult = 1.0;
-        if (hasSalveEI_ || hasSalveE_) salveMult = 1.20;
-        else if (hasSalveI_ || hasSalve_) salveMult = 1.1667;
-        
-        if (salveMult > 1.0) {
-            bool slayerApplied = (multiplier > 1.05); 
-            if (slayerApplied) {
-                multiplier /= 1.1667; 
-            }
-            multiplier *= salveMult;
-        }
-    }
-    
-    // --- Weapon Attributes ---
-    
-    if (isDragon_) {
-        if (isDHL_) multiplier *= 1.20;
-        // DHCB is ranged only
-    }
-    
-    if (isDemon_) {
-        if (isArclight_) multiplier *= 1.70;
-    }
-    
-    if (isKalphite_) {
-        if (isKeris_ || isKerisBreaching_) multiplier *= 1.33;
-    }
-    
-    if (isLeafy_ && isLeafBladed_) {
-        multiplier *= 1.175;
-    }
-    
-    // --- Sets ---
-    
-    // Obsidian (Melee)
-    if (activeSet_ == "Obsidian") {
-         auto weapon = player_.getEquippedItem("weapon").getName();
-         if (weapon.find("Toktz-xil") != std::string::npos || weapon.find("Tzhaar-ket") != std::string::npos) {
-             multiplier *= 1.10;
-         }
-    }
-    
-    // Inquisitor (Crush)
-    if (activeSet_ == "Inquisitor" && style_ == "crush") {
-        multiplier *= 1.025; // 2.5% total
-    } else if (style_ == "crush") {
-        // Individual pieces (0.5% each)
-        if (player_.getEquippedItem("head").getName().find("Inquisitor") != std::string::npos) multiplier *= 1.005;
-        if (player_.getEquippedItem("body").getName().find("Inquisitor") != std::string::npos) multiplier *= 1.005;
-        if (player_.getEquippedItem("legs").getName().find("Inquisitor") != std::string::npos) multiplier *= 1.005;
-    }
-    
-    // --- Specials ---
-    
-    // Dharok
-    if (isDharok_) {
-        double lostHP = (double)(player_.getMaxHP() - player_.getCurrentHP());
-        double hpMult = 1.0 + (lostHP / 100.0 * (player_.getMaxHP() / 100.0));
-        multiplier *= hpMult;
-    }
+double Battle::hitChance() const {
+    return profile_.hitChance(combatStyle_, stance_bonus_attack_);
+}
 
-    return static_cast<int>(baseMax * multiplier);
+void Battle::setSeed(uint64_t seed) {
+    seed_ = seed;
+    gen.seed(seed);
 }
 
-int Battle::attackRoll() {
-    int effAtt = effectiveAttack();
-    
-    if (isRanged_) {
-        int equipAtt = player_.getEquipmentBonus("attack_ranged") - invalid_ranged_att_;
-        int roll = effAtt * (equipAtt + 64);
-        
-        double multiplier = 1.0;
-        if (isUndead_) {
-            if (hasSalveEI_) multiplier *= 1.20;
-            else if (hasSalveI_) multiplier *= 1.1667;
-        }
-        
-        // Slayer Helm (i) Ranged Accuracy
-        if (isOnTask_) {
-             if (player_.hasEquipped("Slayer helmet (i)") ||
-                 player_.hasEquipped("Black mask (i)")) {
-                 multiplier *= 1.15;
-             }
-        }
-        
-        // DHCB Accuracy
-        if (isDragon_ && isDHCB_) {
-            multiplier *= 1.30;
-        }
+uint64_t Battle::scenarioFingerprint() {
+    SimAttackParams params = simAttackParams();
+    uint64_t h = 0xCBF29CE484222325ull;
+    h = fnv1a(h, &params.hp, sizeof params.hp);
+    h = fnv1a(h, &attack_speed_, sizeof attack_speed_);
+    h = fnv1a(h, &params.columns, sizeof params.columns);
+    h = fnv1a(h, params.accept, params.columns * sizeof(uint32_t));
+    h = fnv1a(h, params.alias, params.columns * sizeof(uint32_t));
+    return h;
+}
 
-        // Twisted Bow Accuracy
-        if (isTbow_) {
-             int magic = monster_.getInt("magic_level");
-             int cap = 250;
-             if (magic > cap) magic = cap;
-             // Accuracy formula: 140 + (30*magic - 10)/100 ... rough
-             double tbowAcc = 1.40 + (30 * magic - 10) / 100.0;
-             if (tbowAcc > 2.40) tbowAcc = 2.40; // Cap
-             multiplier *= tbowAcc;
-        }
+bool Battle::replay(const RunManifest& manifest, int threads) {
+    if (manifest.rng != kSimRngName || manifest.scenario != scenarioFingerprint()) return false;
+    return runSimulations(manifest.fights, threads, manifest.seed) == manifest.meanTicks;
+}
 
-        return static_cast<int>(roll * multiplier);
-    }
+int Battle::simulate() {
+    return simulate(gen);
+}
 
-    // EffAtt * (EquipAtt + 64)
-    int equipAtt = player_.getEquipmentBonus("attack_" + style_);
-    int roll = effAtt * (equipAtt + 64);
-    
-    double multiplier = 1.0;
-    
-    // --- Slayer Helm ---
-    if (isOnTask_) {
-        if (player_.hasEquipped("Slayer helmet") || 
-            player_.hasEquipped("Slayer helmet (i)") ||
-            player_.hasEquipped("Black mask") || 
-            player_.hasEquipped("Black mask (i)")) {
-             multiplier *= 1.1667;
-        }
-    }
-    
-    // --- Salve (Undead) ---
-    if (isUndead_) {
-        double salveMult = 1.0;
-        if (hasSalveEI_ || hasSalveE_) salveMult = 1.20;
-        else if (hasSalveI_ || hasSalve_) salveMult = 1.1667;
-        
-        if (salveMult > 1.0) {
-             bool slayerApplied = (multiplier > 1.05);
-             if (slayerApplied) multiplier /= 1.1667;
-             multiplier *= salveMult;
-        }
-    }
-    
-    // --- Weapon Attributes ---
-    if (isDragon_) {
-        if (isDHL_) multiplier *= 1.20;
-    }
-    
-    if (isDemon_) {
-        if (isArclight_) multiplier *= 1.70;
-    }
+double Battle::solveOptimalDPS() {
+    // Refresh state
+    determineStyle();
     
-    if (isKalphite_ && isKerisBreaching_) {
-        multiplier *= 1.33;
-    }
+    StanceDPS best = profile_.bestStance();
     
-    // Obsidian
-    if (activeSet_ == "Obsidian") {
-         auto weapon = player_.getEquippedItem("weapon").getName();
-         if (weapon.find("Toktz-xil") != std::string::npos || weapon.find("Tzhaar-ket") != std::string::npos) {
-             multiplier *= 1.10;
-         }
-    }
+    setStyle(best.option.style);
+    stanceName_ = best.option.name;
+    stance_bonus_attack_ = best.option.stanceAttack;
+    stance_bonus_strength_ = best.option.stanceStrength;
+    attack_speed_ = profile_.weaponSpeed + best.option.speedDelta;
     
-    // Inquisitor (Crush)
-    if (activeSet_ == "Inquisitor" && style_ == "crush") {
-        multiplier *= 1.025;
-    } else if (style_ == "crush") {
-        if (player_.getEquippedItem("head").getName().find("Inquisitor") != std::string::npos) multiplier *= 1.005;
-        if (player_.getEquippedItem("body").getName().find("Inquisitor") != std::string::npos) multiplier *= 1.005;
-        if (player_.getEquippedItem("legs").getName().find("Inquisitor") != std::string::npos) multiplier *= 1.005;
-    }
-    
-    return static_cast<int>(roll * multiplier);
+    return best.dps;
 }
 
-int Battle::defenceRoll() {
-    int def = monster_.getInt("defence_level");
-    int defBonus = 0;
-    
-    if (isRanged_) {
-        defBonus = monster_.getInt("defence_ranged");
-    } else {
-        defBonus = monster_.getInt("defence_" + style_);
-    }
-    
-    return (def + 9) * (defBonus + 64);
+void Battle::optimizeAttackStyle() {
+    solveOptimalDPS();
 }
 
-double Battle::hitChance() {
-    int a = attackRoll();
-    int d = defenceRoll();
-    
-    double p = 0.0;
-    double A = static_cast<double>(a);
-    double D = static_cast<double>(d);
+double Battle::runSimulations(int n) {
+    return runSimulations(n, 1, gen());
+}
 
-    if (A > D) {
-        p = 1.0 - (D + 2.0) / (2.0 * (A + 1.0));
-    } else {
-        p = A / (2.0 * (D + 1.0));
-    }
+AttackShape Battle::attackShape() const {
+    return profile_.attackShape(combatStyle_, stance_bonus_attack_, stance_bonus_strength_);
+}
 
-    if (isFang_ && style_ == "stab") {
-        return 1.0 - (1.0 - p) * (1.0 - p);
+const DamageTable& Battle::damageTable() {
+    if (!damageTableValid_ || tableStyle_ != combatStyle_ ||
+        tableStanceAttack_ != stance_bonus_attack_ || tableStanceStrength_ != stance_bonus_strength_) {
+        damageTable_ = DamageTable(attackShape());
+        damageTableValid_ = true;
+        tableStyle_ = combatStyle_;
+        tableStanceAttack_ = stance_bonus_attack_;
+        tableStanceStrength_ = stance_bonus_strength_;
     }
-
-    return p;
+    return damageTable_;
 }
 
-int Battle::bernoulliTrial(double p) {
-    std::bernoulli_distribution d(p);
-    return d(gen) ? 1 : 0;
+SimAttackParams Battle::simAttackParams() {
+    const DamageTable& table = damageTable();
+    return {profile_.monsterHP, table.columns(), table.acceptData(), table.aliasData()};
 }
 
-int Battle::randomDamage(int max) {
-    int minHit = 0;
-    int maxHit = max;
-    
-    if (isFang_) {
-        minHit = static_cast<int>(max * 0.15);
-        maxHit = static_cast<int>(max * 0.85);
-        if (minHit > maxHit) minHit = maxHit;
-    }
-
-    std::uniform_int_distribution<int> d(minHit, maxHit);
-    return d(gen);
+const TTKSketch& Battle::getLastSketch() const {
+    static const TTKSketch empty;
+    return lastSketch_ ? *lastSketch_ : empty;
 }
 
-int Battle::simulate() {
-    int hp = monster_.getInt("hitpoints");
-    int max = maxHit();
-    double chance = hitChance();
-    int ticks = 0;
-    
-    // Scythe handling
-    int size = monster_.getSize();
-    int hits = 1;
-    if (isScythe_) {
-        if (size == 1) hits = 1;
-        else if (size == 2) hits = 2;
-        else hits = 3;
-    }
+double Battle::runSimulations(int n, int threads, uint64_t seed) {
+    n = std::max(n, 0);
+    double mean = 0.0;
     
-    while (hp > 0) {
-        ticks += attack_speed_;
-        
-        // Hit 1
-        if (bernoulliTrial(chance)) {
-            int dmg = randomDamage(max);
-            // Keris crit check
-            if (isKeris_ && isKalphite_) {
-                 std::uniform_int_distribution<int> crit(1, 51);
-                 if (crit(gen) == 1) dmg *= 3;
-            }
-            hp -= dmg;
-        }
-        
-        // Scythe Hit 2 (50% dmg)
-        if (isScythe_ && hits >= 2 && hp > 0) {
-             if (bernoulliTrial(chance)) {
-                 int dmg = randomDamage(max / 2);
-                 hp -= dmg;
-             }
-        }
-        
-        // Scythe Hit 3 (25% dmg)
-        if (isScythe_ && hits >= 3 && hp > 0) {
-             if (bernoulliTrial(chance)) {
-                 int dmg = randomDamage(max / 4);
-                 hp -= dmg;
-             }
-        }
+    SimAttackParams params = simAttackParams();
+    if (n > 0 && params.hp > 0 && damageTable().canDamage()) {
+        // Every chunk owns an RNG stream derived from (seed, chunk index) only,
+        // so the work split between threads cannot change the result.
+        auto run = [&](uint64_t s, int fights, SimRun& acc) {
+            acc.stats.merge(simulateFightsBatched(params, s, fights, SimBackend::Auto, &acc.sketch));
+        };
+        SimRun result = simulateChunks<SimRun>(run, seed, kSimChunkSize, 0, n, threads);
+        mean = static_cast<double>(result.stats.attacks) * attack_speed_ / n;
+        lastSketch_ = std::make_shared<const TTKSketch>(result.sketch);
+    } else {
+        lastSketch_.reset();
     }
-    return ticks;
+    
+    lastRun_ = {seed, kSimRngName, scenarioFingerprint(), n, mean};
+    return mean;
 }
 
-double Battle::calculateDPS(const std::string& style, int stanceAtt, int stanceStr) {
-    std::string oldStyle = style_;
-    int oldStanceAtt = stance_bonus_attack_;
-    int oldStanceStr = stance_bonus_strength_;
-    
-    style_ = style;
-    stance_bonus_attack_ = stanceAtt;
-    stance_bonus_strength_ = stanceStr;
-    
-    int mHit = maxHit();
-    double chance = hitChance();
-    
-    // Calculate average damage per attack sequence
-    double avgDmg = 0.0;
+SimulationEstimate Battle::runSimulationsReduced(int n, int threads, uint64_t seed) {
+    SimAttackParams params = simAttackParams();
+    if (n < 2 || params.hp <= 0 || !damageTable().canDamage()) return {0.0, 0.0, 0.0, 0, true, 1.0};
     
-    // Base Hit
-    double hit1 = (double)mHit * 0.5 * chance;
+    auto run = [&](uint64_t s, int pairs, PairedSimStats& acc) {
+        acc.merge(simulatePairsBatched(params, s, pairs));
+    };
+    PairedSimStats stats = simulateChunks<PairedSimStats>(run, seed, kSimChunkSize / 2, 0, n / 2, threads);
+    return estimate(stats, attack_speed_, params.hp, damageTable().mean());
+}
 
-    // Keris Crit
-    if (isKeris_ && isKalphite_) {
-        hit1 *= (53.0/51.0);
-    }
-    
-    avgDmg += hit1;
-    
-    // Scythe Extra Hits
-    if (isScythe_) {
-        int size = monster_.getSize();
-        if (size >= 2) {
-            avgDmg += (double)(mHit / 2) * 0.5 * chance;
-        }
-        if (size >= 3) {
-            avgDmg += (double)(mHit / 4) * 0.5 * chance;
-        }
-    }
-    
-    style_ = oldStyle;
-    stance_bonus_attack_ = oldStanceAtt;
-    stance_bonus_strength_ = oldStanceStr;
-    
-    double secondsPerHit = (double)attack_speed_ * 0.6;
-    
-    return avgDmg / secondsPerHit;
+SimulationEstimate Battle::runSimulationsAdaptive(double relativeError, int maxFights) {
+    PrecisionTarget target;
+    target.relativeError = relativeError;
+    target.maxFights = maxFights;
+    return runSimulationsAdaptive(target, 0, gen());
 }
 
-double Battle::solveOptimalDPS() {
-    struct Option {
-        std::string style;
-        std::string stanceName;
-        int stanceAtt;
-        int stanceStr;
-        double dps;
-    };
-    
-    // Refresh state
-    determineStyle();
+SimulationEstimate Battle::runSimulationsAdaptive(const PrecisionTarget& target, int threads, uint64_t seed) {
+    SimAttackParams params = simAttackParams();
+    if (params.hp <= 0 || !damageTable().canDamage()) return {0.0, 0.0, 0.0, 0, true, 1.0};
     
-    // Base speed check
-    attack_speed_ = 4;
-    auto gear = player_.getGear();
-    if (gear.count("weapon")) {
-        Item weapon = gear.at("weapon");
-        int speed = weapon.getInt("attack_speed");
-        if (speed > 0) attack_speed_ = speed;
-    }
-
-    std::vector<Option> options;
-    if (isRanged_) {
-        // Ranged Options
-        // Accurate: +3 Range (Att & Str)
-        options.push_back({"ranged", "Accurate (+3 Range)", 3, 3, 0.0});
-        // Rapid: Speed -1, +0 stats
-        options.push_back({"ranged", "Rapid (Speed -1)", 0, 0, 0.0});
-        // Longrange: +3 Def (0 range stats)
-        options.push_back({"ranged", "Longrange (+3 Def)", 0, 0, 0.0});
-    } else {
-        options = {
-            {"stab", "Accurate (+3 Att)", 3, 0, 0.0},
-            {"stab", "Aggressive (+3 Str)", 0, 3, 0.0},
-            {"slash", "Accurate (+3 Att)", 3, 0, 0.0},
-            {"slash", "Aggressive (+3 Str)", 0, 3, 0.0},
-            {"crush", "Accurate (+3 Att)", 3, 0, 0.0},
-            {"crush", "Aggressive (+3 Str)", 0, 3, 0.0}
-        };
-    }
+    int maxFights = std::max(2, target.maxFights);
+    if (target.reduceVariance) maxFights -= maxFights % 2; // Whole pairs only
+    auto roundUp = [&](long long n) {
+        n = (n + kAdaptiveChunkSize - 1) / kAdaptiveChunkSize * kAdaptiveChunkSize;
+        return static_cast<int>(std::min<long long>(n, maxFights));
+    };
     
-    Option bestOption = options[0];
-    bestOption.dps = -1.0;
+    // Tightest requested half-width
+    auto goal = [&](const SimulationEstimate& est) {
+        double g = std::numeric_limits<double>::infinity();
+        if (target.relativeError > 0.0) g = std::min(g, target.relativeError * est.meanTicks);
+        if (target.ciHalfWidthTicks > 0.0) g = std::min(g, target.ciHalfWidthTicks);
+        return g;
+    };
     
-    for (auto& opt : options) {
-        int oldSpeed = attack_speed_;
-        if (opt.stanceName.find("Rapid") != std::string::npos) {
-            attack_speed_ -= 1;
+    // Rounds always cover whole chunks, so the fights simulated and the
+    // stopping point depend only on the seed and the target.
+    SimStats plain;
+    PairedSimStats paired;
+    SimulationEstimate est {};
+    int done = 0;
+    int next = roundUp(std::max(target.minFights, 2));
+    while (true) {
+        if (target.reduceVariance) {
+            auto run = [&](uint64_t s, int pairs, PairedSimStats& acc) {
+                acc.merge(simulatePairsBatched(params, s, pairs));
+            };
+            paired.merge(simulateChunks<PairedSimStats>(run, seed, kAdaptiveChunkSize / 2,
+                                                        done / 2, (next - done) / 2, threads));
+            est = estimate(paired, attack_speed_, params.hp, damageTable().mean());
+        } else {
+            auto run = [&](uint64_t s, int fights, SimStats& acc) {
+                acc.merge(simulateFightsBatched(params, s, fights));
+            };
+            plain.merge(simulateChunks<SimStats>(run, seed, kAdaptiveChunkSize, done, next - done, threads));
+            est = estimate(plain, attack_speed_);
         }
+        done = next;
         
-        opt.dps = calculateDPS(opt.style, opt.stanceAtt, opt.stanceStr);
+        double g = goal(est);
+        est.converged = est.ciHalfWidthTicks <= g;
+        if (est.converged || next >= maxFights) break;
         
-        if (opt.dps > bestOption.dps) {
-            bestOption = opt;
+        // Fights the current error estimate says are needed, growing at
+        // most 4x per round in case the early estimate is poor
+        double ratio = est.ciHalfWidthTicks / g;
+        double needed = std::ceil(done * ratio * ratio);
+        long long want = static_cast<long long>(std::min(needed, 4.0 * done));
+        next = roundUp(std::max<long long>(want, done + kAdaptiveChunkSize));
+    }
+    return est;
+}
+
+TTKDistribution Battle::solveTTK() {
+    TTKDistribution ttk {0.0, 0.0, 0.0, 0.0, 0, 0, 0, false, true};
+    
+    int hp = profile_.monsterHP;
+    if (hp <= 0) {
+        ttk.killable = true;
+        return ttk;
+    }
+    
+    const std::vector<double>& pmf = damageTable().pmf();
+    double p0 = pmf[0];
+    if (p0 >= 1.0 - 1e-12) return ttk;
+    ttk.killable = true;
+    
+    int maxDmg = static_cast<int>(pmf.size()) - 1;
+    
+    // First and second moments of the number of attacks needed from h remaining HP.
+    // K(h) = 1 + K(h - d); the d = 0 self-loop is solved in closed form.
+    std::vector<double> e1(hp + 1, 0.0);
+    std::vector<double> e2(hp + 1, 0.0);
+    for (int h = 1; h <= hp; ++h) {
+        double s1 = 1.0;
+        double s2 = 1.0;
+        int top = std::min(maxDmg, h - 1);
+        for (int d = 1; d <= top; ++d) {
+            s1 += pmf[d] * e1[h - d];
+            s2 += pmf[d] * (2.0 * e1[h - d] + e2[h - d]);
+        }
+        e1[h] = s1 / (1.0 - p0);
+        e2[h] = (s2 + 2.0 * p0 * e1[h]) / (1.0 - p0);
+    }
+    
+    double meanAttacks = e1[hp];
+    double varAttacks = std::max(0.0, e2[hp] - meanAttacks * meanAttacks);
+    
+    ttk.expectedAttacks = meanAttacks;
+    ttk.expectedTicks = meanAttacks * attack_speed_;
+    ttk.expectedSeconds = ttk.expectedTicks * 0.6;
+    ttk.varianceTicks = varAttacks * attack_speed_ * attack_speed_;
+    
+    // Percentiles: push the alive-HP distribution forward one attack at a time
+    // until 99% of the probability mass has died, within a fixed work budget.
+    std::vector<double> alive(hp + 1, 0.0);
+    std::vector<double> next(hp + 1, 0.0);
+    alive[hp] = 1.0;
+    int lo = hp;
+    double dead = 0.0;
+    int attacks = 0;
+    int* targets[3] = {&ttk.p50Ticks, &ttk.p90Ticks, &ttk.p99Ticks};
+    const double quantiles[3] = {0.50, 0.90, 0.99};
+    int found = 0;
+    long long work = 0;
+    
+    while (found < 3 && work < kTTKStepBudget) {
+        ++attacks;
+        std::fill(next.begin() + std::max(1, lo - maxDmg), next.end(), 0.0);
+        int newLo = hp;
+        for (int h = lo; h <= hp; ++h) {
+            double a = alive[h];
+            if (a == 0.0) continue;
+            int top = std::min(maxDmg, h - 1);
+            for (int d = 0; d <= top; ++d) {
+                next[h - d] += a * pmf[d];
+            }
+            if (h - top < newLo) newLo = h - top;
         }
+        work += static_cast<long long>(hp - lo + 1) * (maxDmg + 1);
         
-        // Restore speed
-        attack_speed_ = oldSpeed;
-    }
-    
-    style_ = bestOption.style;
-    stance_bonus_attack_ = bestOption.stanceAtt;
-    stance_bonus_strength_ = bestOption.stanceStr;
-    
-    if (bestOption.stanceName.find("Rapid") != std::string::npos) {
-        attack_speed_ -= 1;
+        double stillAlive = 0.0;
+        for (int h = newLo; h <= hp; ++h) stillAlive += next[h];
+        dead = 1.0 - stillAlive;
+        
+        alive.swap(next);
+        lo = newLo;
+        
+        while (found < 3 && dead >= quantiles[found] - 1e-12) {
+            *targets[found] = attacks * attack_speed_;
+            ++found;
+        }
     }
     
-    return bestOption.dps;
-}
-
-void Battle::optimizeAttackStyle() {
-    double dps = solveOptimalDPS();
-    
-    std::string stanceName = "Unknown";
-    if (stance_bonus_attack_ == 3) stanceName = "Accurate (+3 Att)";
-    else if (stance_bonus_strength_ == 3) stanceName = "Aggressive (+3 Str)";
-}
-
-double Battle::runSimulations(int n) {
-    long totalTicks = 0;
-    for (int i = 0; i < n; ++i) {
-        totalTicks += simulate();
-    }
-    return static_cast<double>(totalTicks) / n;
+    // Long fights (low accuracy, high HP) take the rest from a gamma fitted to
+    // the exact mean and variance of the attack count, via Wilson-Hilferty.
+    // Exponential waits for a rare hit and normal sums of many hits are both
+    // gammas, so the fit covers either end. The quantile has not been reached
+    // after `attacks`, which bounds it from below.
+    ttk.percentilesExact = found == 3;
+    int floorAttacks = attacks + 1;
+    for (; found < 3; ++found) {
+        double shape = varAttacks > 0.0 ? meanAttacks * meanAttacks / varAttacks : 1e12;
+        double c = 1.0 / (9.0 * shape);
+        double cube = std::max(0.0, 1.0 - c + kTTKQuantileZ[found] * std::sqrt(c));
+        double fitted = std::ceil(meanAttacks * cube * cube * cube);
+        int n = static_cast<int>(std::min<double>(std::max<double>(fitted, floorAttacks),
+                                                  std::numeric_limits<int>::max() / attack_speed_));
+        *targets[found] = n * attack_speed_;
+        floorAttacks = n;
+    }
+    
+    return ttk;
 }
 
 int Battle::getMaxHit() {
@@ -702,22 +520,8 @@ double Battle::getHitChance() {
 }
 
 double Battle::getDPS() {
-    int mHit = maxHit();
-    double chance = hitChance();
-    double avgDmg = 0.0;
-    
-    double hit1 = (double)mHit * 0.5 * chance;
-    if (isKeris_ && isKalphite_) hit1 *= (53.0/51.0);
-    avgDmg += hit1;
-    
-    if (isScythe_) {
-        int size = monster_.getSize();
-        if (size >= 2) avgDmg += (double)(mHit / 2) * 0.5 * chance;
-        if (size >= 3) avgDmg += (double)(mHit / 4) * 0.5 * chance;
-    }
-
     double secondsPerHit = (double)attack_speed_ * 0.6;
-    return avgDmg / secondsPerHit;
+    return damageTable().mean() / secondsPerHit;
 }
 
 BattleResult Battle::getResults() {
@@ -729,34 +533,54 @@ BattleResult Battle::getResults() {
     result.hitChance = hitChance();
     result.style = style_;
     result.attackSpeed = attack_speed_;
-    result.isFang = isFang_;
-    result.isDHL = isDHL_;
-    result.hasSalve = hasSalve_ || hasSalveE_ || hasSalveI_ || hasSalveEI_;
-    
-    result.isDHCB = isDHCB_;
-    result.isArclight = isArclight_;
-    result.isKeris = isKeris_;
-    result.isScythe = isScythe_;
-    result.isTbow = isTbow_;
-    result.onTask = isOnTask_;
+    result.isFang = profile_.isFang;
+    result.isDHL = profile_.isDHL;
+    result.hasSalve = profile_.hasSalve;
+    
+    result.isDHCB = profile_.isDHCB;
+    result.isArclight = profile_.isArclight;
+    result.isKeris = profile_.isKeris;
+    result.isScythe = profile_.isScythe;
+    result.isTbow = profile_.isTbow;
+    result.onTask = profile_.onTask;
     result.activeSet = activeSet_;
     
-    if (stance_bonus_attack_ > 0) {
-        result.stance = "Accurate";
-    } else if (stance_bonus_strength_ > 0) {
-        result.stance = "Aggressive";
-    } else {
-        result.stance = "Controlled";
-    }
+    result.stance = stanceName_;
     
-    int monsterHP = monster_.getInt("hitpoints");
-    if (result.dps > 0 && monsterHP > 0) {
-        result.avgTTK = monsterHP / result.dps;
+    StanceTable table = profile_.stanceTable();
+    result.stances.assign(table.rows, table.rows + table.count);
+    
+    // Exact kill time accounts for overkill and the spread of hits, unlike HP / DPS
+    TTKDistribution ttk = solveTTK();
+    if (ttk.killable && ttk.expectedSeconds > 0) {
+        result.avgTTK = ttk.expectedSeconds;
+        result.ttkStdDev = std::sqrt(ttk.varianceTicks) * 0.6;
+        result.ttkP50 = ttk.p50Ticks * 0.6;
+        result.ttkP90 = ttk.p90Ticks * 0.6;
+        result.ttkP99 = ttk.p99Ticks * 0.6;
+        result.ttkPercentilesExact = ttk.percentilesExact;
         result.killsPerHour = 3600.0 / result.avgTTK;
     } else {
         result.avgTTK = 0;
+        result.ttkStdDev = 0;
+        result.ttkP50 = 0;
+        result.ttkP90 = 0;
+        result.ttkP99 = 0;
+        result.ttkPercentilesExact = true;
         result.killsPerHour = 0;
     }
     
+    // Simulated distribution only from a run the caller made on this attack
+    result.simTTKP50 = 0;
+    result.simTTKP90 = 0;
+    result.simTTKP99 = 0;
+    if (lastSketch_ && lastSketch_->fights() > 0 && lastRun_.scenario == scenarioFingerprint()) {
+        double tickSeconds = attack_speed_ * 0.6;
+        result.simTTKP50 = lastSketch_->quantileAttacks(0.50) * tickSeconds;
+        result.simTTKP90 = lastSketch_->quantileAttacks(0.90) * tickSeconds;
+        result.simTTKP99 = lastSketch_->quantileAttacks(0.99) * tickSeconds;
+        result.ttkHistogram = lastSketch_->histogram(attack_speed_);
+    }
+    
     return result;
 }
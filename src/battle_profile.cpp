@@ -0,0 +1,373 @@
+// battle_profile.cpp
+#include "battle_profile.h"
+#include <algorithm>
+
+static_assert(static_cast<int>(CombatStyle::Ranged) == static_cast<int>(DefenceStyle::Ranged),
+              "The four CombatStyles index MonsterCombat::defenceRoll");
+
+namespace {
+// Hit chance from the attack and defence rolls
+double chanceFromRolls(int attackRoll, int defenceRoll, bool doubleRoll) {
+    double A = static_cast<double>(attackRoll);
+    double D = static_cast<double>(defenceRoll);
+
+    double p = A > D ? 1.0 - (D + 2.0) / (2.0 * (A + 1.0)) : A / (2.0 * (D + 1.0));
+
+    if (doubleRoll) return 1.0 - (1.0 - p) * (1.0 - p);
+    return p;
+}
+
+// Stances in table order, first wins on ties
+const StanceOption kMeleeStances[] = {
+    {CombatStyle::Stab, "Accurate", 3, 0, 0},
+    {CombatStyle::Stab, "Aggressive", 0, 3, 0},
+    {CombatStyle::Stab, "Controlled", 1, 1, 0},
+    {CombatStyle::Stab, "Defensive", 0, 0, 0},
+    {CombatStyle::Slash, "Accurate", 3, 0, 0},
+    {CombatStyle::Slash, "Aggressive", 0, 3, 0},
+    {CombatStyle::Slash, "Controlled", 1, 1, 0},
+    {CombatStyle::Slash, "Defensive", 0, 0, 0},
+    {CombatStyle::Crush, "Accurate", 3, 0, 0},
+    {CombatStyle::Crush, "Aggressive", 0, 3, 0},
+    {CombatStyle::Crush, "Controlled", 1, 1, 0},
+    {CombatStyle::Crush, "Defensive", 0, 0, 0},
+};
+
+const StanceOption kRangedStances[] = {
+    {CombatStyle::Ranged, "Accurate", 3, 3, 0},
+    {CombatStyle::Ranged, "Rapid", 0, 0, -1},
+    {CombatStyle::Ranged, "Longrange", 0, 0, 0},
+};
+
+// Stance bonuses that occur in the tables above
+constexpr int kStanceBonuses[] = {0, 1, 3};
+}
+
+CombatStyle combatStyleFromString(const std::string& style) {
+    if (style == "stab") return CombatStyle::Stab;
+    if (style == "slash") return CombatStyle::Slash;
+    if (style == "crush") return CombatStyle::Crush;
+    return CombatStyle::Ranged;
+}
+
+const char* combatStyleName(CombatStyle style) {
+    switch (style) {
+        case CombatStyle::Stab: return "stab";
+        case CombatStyle::Slash: return "slash";
+        case CombatStyle::Crush: return "crush";
+        default: return "ranged";
+    }
+}
+
+BattleProfile BattleProfile::compile(const Player& player, const Monster& monster) {
+    return compile(player, player.getLoadout(), monster);
+}
+
+BattleProfile BattleProfile::compile(const Player& player, const Loadout& gear, const Monster& monster) {
+    BattleProfile p;
+    GearSet activeSet = gear.activeGearSet();
+
+    // --- Gear effects ---
+    bool kerisBreaching = false;
+    bool leafBladed = false;
+    bool obsidianWeapon = false;
+    bool hasSalveE = false, hasSalveI = false, hasSalveEI = false;
+
+    const Item* weapon = gear.get(GearSlot::Weapon);
+    if (weapon) {
+        int speed = weapon->getStat(ItemStat::AttackSpeed);
+        if (speed > 0) p.weaponSpeed = speed;
+
+        p.isFang = weapon->hasEffect(ItemEffect::OsmumtensFang);
+        p.isDHL = weapon->hasEffect(ItemEffect::DragonHunterLance);
+        p.isDHCB = weapon->hasEffect(ItemEffect::DragonHunterCrossbow);
+        p.isArclight = weapon->hasEffect(ItemEffect::Arclight);
+        p.isKeris = weapon->hasEffect(ItemEffect::Keris);
+        kerisBreaching = weapon->hasEffect(ItemEffect::KerisBreaching);
+        leafBladed = weapon->hasEffect(ItemEffect::LeafBladed);
+        p.isScythe = weapon->hasEffect(ItemEffect::ScytheOfVitur);
+        p.isTbow = weapon->hasEffect(ItemEffect::TwistedBow);
+        p.dharok = activeSet == GearSet::Dharok && weapon->hasEffect(ItemEffect::DharokGreataxe);
+        obsidianWeapon = weapon->hasEffect(ItemEffect::ObsidianWeapon);
+    }
+
+    if (const Item* neck = gear.get(GearSlot::Neck); neck && neck->hasEffect(ItemEffect::Salve)) {
+        if (neck->hasEffect(ItemEffect::SalveEI)) hasSalveEI = true;
+        else if (neck->hasEffect(ItemEffect::SalveI)) hasSalveI = true;
+        else if (neck->hasEffect(ItemEffect::SalveE)) hasSalveE = true;
+        else p.hasSalve = true;
+    }
+
+    const Item* ammo = gear.get(GearSlot::Ammo);
+    if (ammo && (!weapon || !ammoCompatible(weapon->getWeaponClass(), ammo->getAmmoClass()))) {
+        p.invalidRangedStrength = ammo->getStat(ItemStat::RangedStrength);
+        p.invalidRangedAttack = ammo->getStat(ItemStat::AttackRanged);
+    }
+
+    p.onTask = player.isOnSlayerTask();
+    const Item* head = gear.get(GearSlot::Head);
+    bool slayerHelm = head && head->hasEffect(ItemEffect::SlayerHelm);
+    bool slayerHelmI = head && head->hasEffect(ItemEffect::SlayerHelmI);
+
+    // --- Bonuses ---
+    p.equipAttack[0] = gear.bonus(ItemStat::AttackStab);
+    p.equipAttack[1] = gear.bonus(ItemStat::AttackSlash);
+    p.equipAttack[2] = gear.bonus(ItemStat::AttackCrush);
+    p.equipAttack[3] = gear.bonus(ItemStat::AttackRanged);
+    // Try strength_bonus, fallback to melee_strength if 0 (heuristic)
+    p.meleeStrength = gear.bonus(ItemStat::StrengthBonus);
+    if (p.meleeStrength == 0) p.meleeStrength = gear.bonus(ItemStat::MeleeStrength);
+    p.rangedStrength = gear.bonus(ItemStat::RangedStrength);
+
+    // --- Levels: (Level + Boost) * Prayer, then Void ---
+    int att = player.getBoostedLevel(Skill::Attack);
+    int str = player.getBoostedLevel(Skill::Strength);
+    int rng = player.getBoostedLevel(Skill::Ranged);
+    if (player.isPietyActive()) {
+        att = static_cast<int>(att * 1.20);
+        str = static_cast<int>(str * 1.23);
+    }
+    if (activeSet == GearSet::VoidMelee || activeSet == GearSet::EliteVoidMelee) {
+        att = static_cast<int>(att * 1.10);
+        str = static_cast<int>(str * 1.10);
+    }
+    p.meleeAttackLevel = att;
+    p.meleeStrengthLevel = str;
+    p.rangedAttackLevel = player.isRigourActive() ? static_cast<int>(rng * 1.20) : rng;
+    p.rangedStrengthLevel = player.isRigourActive() ? static_cast<int>(rng * 1.23) : rng;
+
+    // --- Melee multipliers ---
+    const MonsterCombat& target = monster.combat();
+    bool isUndead = monster.isUndead();
+    bool isDragon = monster.isDragon();
+    bool isDemon = monster.isDemon();
+    bool isKalphite = monster.isKalphite();
+
+    double dmg = 1.0;
+    double acc = 1.0;
+    if (p.onTask && slayerHelm) {
+        dmg *= 1.1667;
+        acc *= 1.1667;
+    }
+    if (isUndead) {
+        double salveMult = 1.0;
+        if (hasSalveEI || hasSalveE) salveMult = 1.20;
+        else if (hasSalveI || p.hasSalve) salveMult = 1.1667;
+
+        // Salve replaces the slayer helm bonus
+        if (salveMult > 1.0) {
+            if (dmg > 1.05) dmg /= 1.1667;
+            if (acc > 1.05) acc /= 1.1667;
+            dmg *= salveMult;
+            acc *= salveMult;
+        }
+    }
+    if (isDragon && p.isDHL) {
+        dmg *= 1.20;
+        acc *= 1.20;
+    }
+    if (isDemon && p.isArclight) {
+        dmg *= 1.70;
+        acc *= 1.70;
+    }
+    if (isKalphite && p.isKeris) dmg *= 1.33;
+    if (isKalphite && kerisBreaching) acc *= 1.33;
+    if (monster.isLeafy() && leafBladed) dmg *= 1.175;
+    if (activeSet == GearSet::Obsidian && obsidianWeapon) {
+        dmg *= 1.10;
+        acc *= 1.10;
+    }
+    p.meleeDamageMult = dmg;
+    p.meleeAccuracyMult = acc;
+
+    p.inquisitorSet = activeSet == GearSet::Inquisitor;
+    p.inquisitorPieces = gear.setPieces(GearSet::Inquisitor);
+
+    if (p.dharok) {
+        double lostHP = (double)(player.getMaxHP() - player.getCurrentHP());
+        p.dharokMult = 1.0 + (lostHP / 100.0 * (player.getMaxHP() / 100.0));
+    }
+
+    // --- Ranged multipliers ---
+    dmg = 1.0;
+    acc = 1.0;
+    // Salve Amulet (i) and (ei) boost Ranged
+    if (isUndead) {
+        if (hasSalveEI) { dmg *= 1.20; acc *= 1.20; }
+        else if (hasSalveI) { dmg *= 1.1667; acc *= 1.1667; }
+    }
+    if (p.onTask && slayerHelmI) {
+        dmg *= 1.15;
+        acc *= 1.15;
+    }
+    if (isDragon && p.isDHCB) {
+        dmg *= 1.30;
+        acc *= 1.30;
+    }
+    if (p.isTbow) {
+        int magic = std::min(target.magicLevel, 250);
+
+        double tbowMult = 0.25 + (magic * 3 - 14) / 100.0;
+        dmg *= std::clamp(tbowMult, 1.0, 2.5);
+
+        // Accuracy formula: 140 + (30*magic - 10)/100 ... rough
+        double tbowAcc = 1.40 + (30 * magic - 10) / 100.0;
+        acc *= std::min(tbowAcc, 2.40);
+    }
+    p.rangedDamageMult = dmg;
+    p.rangedAccuracyMult = acc;
+
+    p.hasSalve = p.hasSalve || hasSalveE || hasSalveI || hasSalveEI;
+
+    // --- Special rolls ---
+    if (p.isScythe) {
+        int size = target.size;
+        p.hits = size == 1 ? 1 : (size == 2 ? 2 : 3);
+    }
+    p.kerisCrit = p.isKeris && isKalphite;
+
+    // --- Monster ---
+    p.monsterHP = target.hitpoints;
+    std::copy_n(target.defenceRoll, 4, p.defenceRolls);
+
+    return p;
+}
+
+CombatStyle BattleProfile::defaultStyle() const {
+    int stab = equipAttack[0];
+    int slash = equipAttack[1];
+    int crush = equipAttack[2];
+    int range = equipAttack[3];
+
+    // Simple heuristic: pick highest bonus
+    if (range > stab && range > slash && range > crush) return CombatStyle::Ranged;
+    if (stab >= slash && stab >= crush) return CombatStyle::Stab;
+    if (slash >= stab && slash >= crush) return CombatStyle::Slash;
+    return CombatStyle::Crush;
+}
+
+int BattleProfile::effectiveAttack(CombatStyle style, int stanceAttack) const {
+    int level = style == CombatStyle::Ranged ? rangedAttackLevel : meleeAttackLevel;
+    return level + 8 + stanceAttack;
+}
+
+int BattleProfile::effectiveStrength(CombatStyle style, int stanceStrength) const {
+    int level = style == CombatStyle::Ranged ? rangedStrengthLevel : meleeStrengthLevel;
+    return level + 8 + stanceStrength;
+}
+
+int BattleProfile::attackBonus(CombatStyle style) const {
+    int bonus = equipAttack[static_cast<int>(style)];
+    return style == CombatStyle::Ranged ? bonus - invalidRangedAttack : bonus;
+}
+
+int BattleProfile::strengthBonus(CombatStyle style) const {
+    return style == CombatStyle::Ranged ? rangedStrength - invalidRangedStrength : meleeStrength;
+}
+
+double BattleProfile::damageMultiplier(CombatStyle style) const {
+    if (style == CombatStyle::Ranged) return rangedDamageMult;
+
+    double multiplier = meleeDamageMult;
+    if (style == CombatStyle::Crush) {
+        if (inquisitorSet) multiplier *= 1.025; // 2.5% total
+        else for (int i = 0; i < inquisitorPieces; ++i) multiplier *= 1.005; // 0.5% per piece
+    }
+    if (dharok) multiplier *= dharokMult;
+    return multiplier;
+}
+
+double BattleProfile::accuracyMultiplier(CombatStyle style) const {
+    if (style == CombatStyle::Ranged) return rangedAccuracyMult;
+
+    double multiplier = meleeAccuracyMult;
+    if (style == CombatStyle::Crush) {
+        if (inquisitorSet) multiplier *= 1.025;
+        else for (int i = 0; i < inquisitorPieces; ++i) multiplier *= 1.005;
+    }
+    return multiplier;
+}
+
+int BattleProfile::maxHit(CombatStyle style, int stanceStrength) const {
+    // ((EffStr * (EquipStr + 64) + 320) / 640) * multipliers
+    int baseMax = (effectiveStrength(style, stanceStrength) * (strengthBonus(style) + 64) + 320) / 640;
+    return static_cast<int>(baseMax * damageMultiplier(style));
+}
+
+int BattleProfile::attackRoll(CombatStyle style, int stanceAttack) const {
+    // EffAtt * (EquipAtt + 64) * multipliers
+    int roll = effectiveAttack(style, stanceAttack) * (attackBonus(style) + 64);
+    return static_cast<int>(roll * accuracyMultiplier(style));
+}
+
+int BattleProfile::defenceRoll(CombatStyle style) const {
+    return defenceRolls[static_cast<int>(style)];
+}
+
+double BattleProfile::hitChance(CombatStyle style, int stanceAttack) const {
+    // Fang rolls accuracy twice on stab
+    return chanceFromRolls(attackRoll(style, stanceAttack), defenceRoll(style),
+                           isFang && style == CombatStyle::Stab);
+}
+
+AttackShape BattleProfile::attackShape(CombatStyle style, int stanceAttack, int stanceStrength) const {
+    return {maxHit(style, stanceStrength), hitChance(style, stanceAttack), hits, isFang, kerisCrit};
+}
+
+double BattleProfile::dps(CombatStyle style, int stanceAttack, int stanceStrength, int attackSpeed) const {
+    // Average damage per attack sequence, same distribution as the simulator
+    double avgDmg = DamageTable::expectedDamage(attackShape(style, stanceAttack, stanceStrength));
+    return avgDmg / (attackSpeed * 0.6);
+}
+
+StanceTable BattleProfile::stanceTable() const {
+    bool ranged = defaultStyle() == CombatStyle::Ranged;
+    const StanceOption* begin = ranged ? std::begin(kRangedStances) : std::begin(kMeleeStances);
+    const StanceOption* end = ranged ? std::end(kRangedStances) : std::end(kMeleeStances);
+
+    StanceTable table;
+    int maxHits[4] = {0, 0, 0, 0};      // By strength stance bonus
+    double chances[4] = {0, 0, 0, 0};   // By attack stance bonus
+    bool haveStyle = false;
+    CombatStyle style = CombatStyle::Stab;
+
+    for (const StanceOption* opt = begin; opt != end; ++opt) {
+        // Stances of one style only differ by a small level bonus, so the
+        // style's max hits and hit chances are computed once for all of them
+        if (!haveStyle || opt->style != style) {
+            style = opt->style;
+            haveStyle = true;
+
+            int strBonus = strengthBonus(style) + 64;
+            int attBonus = attackBonus(style) + 64;
+            double dmgMult = damageMultiplier(style);
+            double accMult = accuracyMultiplier(style);
+            int defRoll = defenceRoll(style);
+            bool doubleRoll = isFang && style == CombatStyle::Stab;
+
+            for (int b : kStanceBonuses) {
+                int baseMax = (effectiveStrength(style, b) * strBonus + 320) / 640;
+                maxHits[b] = static_cast<int>(baseMax * dmgMult);
+                int roll = static_cast<int>(effectiveAttack(style, b) * attBonus * accMult);
+                chances[b] = chanceFromRolls(roll, defRoll, doubleRoll);
+            }
+        }
+
+        StanceDPS& row = table.rows[table.count];
+        row.option = *opt;
+        row.attackSpeed = weaponSpeed + opt->speedDelta;
+        row.maxHit = maxHits[opt->stanceStrength];
+        row.hitChance = chances[opt->stanceAttack];
+        double avgDmg = DamageTable::expectedDamage({row.maxHit, row.hitChance, hits, isFang, kerisCrit});
+        row.dps = avgDmg / (row.attackSpeed * 0.6);
+
+        if (table.best < 0 || row.dps > table.rows[table.best].dps) table.best = table.count;
+        ++table.count;
+    }
+    return table;
+}
+
+StanceDPS BattleProfile::bestStance() const {
+    StanceTable table = stanceTable();
+    return table.rows[table.best];
+}
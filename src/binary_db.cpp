@@ -0,0 +1,344 @@
+// binary_db.cpp
+#include "binary_db.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <utility>
+
+#ifndef __EMSCRIPTEN__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace binarydb;
+
+namespace {
+// JSON keys of the MonsterField values
+const char* const kMonsterFieldKeys[kMonsterFieldCount] = {
+    "hitpoints", "combat_level", "attack_level", "strength_level", "defence_level", "magic_level",
+    "ranged_level", "max_hit", "attack_speed", "size", "defence_stab", "defence_slash", "defence_crush",
+    "defence_magic", "defence_ranged"
+};
+
+// Collects the string blob while the tables are built
+class StringTable {
+    private:
+        std::string blob_;
+
+    public:
+        StringRef add(const std::string& s) {
+            StringRef ref {static_cast<uint32_t>(blob_.size()), static_cast<uint32_t>(s.size())};
+            blob_ += s;
+            return ref;
+        }
+        const std::string& blob() const { return blob_; }
+};
+
+int intOr(const json& object, const char* key, int fallback) {
+    auto it = object.find(key);
+    return (it != object.end() && it->is_number_integer()) ? it->get<int>() : fallback;
+}
+
+std::string strOr(const json& object, const char* key) {
+    auto it = object.find(key);
+    return (it != object.end() && it->is_string()) ? it->get<std::string>() : "";
+}
+
+bool parseId(const std::string& s, int& id) {
+    try {
+        id = std::stoi(s);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+ItemRecord compileItem(int id, const json& item, StringTable& strings) {
+    ItemRecord record {};
+    record.id = id;
+    if (item.value("tradeable_on_ge", false)) record.flags |= kItemTradeable;
+    if (item.value("equipable_by_player", false)) record.flags |= kItemEquipable;
+    record.name = strings.add(strOr(item, "name"));
+
+    const json& equipment = item["equipment"];
+    for (int i = 0; i < kItemStatCount; ++i) {
+        record.stats[i] = intOr(equipment, itemStatKey(static_cast<ItemStat>(i)), 0);
+    }
+    record.slot = strings.add(strOr(equipment, "slot"));
+
+    // The weapon section overrides equipment keys, as in parseItemJSON
+    auto weapon = item.find("weapon");
+    std::string weaponType;
+    if (weapon != item.end() && weapon->is_object()) {
+        for (int i = 0; i < kItemStatCount; ++i) {
+            record.stats[i] = intOr(*weapon, itemStatKey(static_cast<ItemStat>(i)), record.stats[i]);
+        }
+        weaponType = strOr(*weapon, "weapon_type");
+    }
+    record.weaponType = strings.add(weaponType);
+
+    ItemTraits traits = ItemEffectRegistry::instance().lookup(id, strOr(item, "name"), weaponType);
+    record.effects = traits.effects;
+    record.weaponClass = static_cast<uint8_t>(traits.weaponClass);
+    record.ammoClass = static_cast<uint8_t>(traits.ammoClass);
+    return record;
+}
+
+MonsterRecord compileMonster(uint32_t source, bool prefixMatch, const json& monster, StringTable& strings) {
+    MonsterRecord record {};
+    record.name = strings.add(strOr(monster, "name"));
+    record.source = source;
+    record.flags = prefixMatch ? kMonsterPrefixMatch : 0;
+    for (int i = 0; i < kMonsterFieldCount; ++i) {
+        auto it = monster.find(kMonsterFieldKeys[i]);
+        if (it == monster.end() || !it->is_number_integer()) continue;
+        record.present |= 1u << i;
+        record.fields[i] = it->get<int>();
+    }
+
+    // Resolve the attribute strings the way Monster does
+    auto attributes = monster.find("attributes");
+    if (attributes != monster.end() && attributes->is_array()) {
+        Monster parsed;
+        for (const auto& attr : *attributes) {
+            if (attr.is_string()) parsed.addAttribute(attr.get<std::string>());
+        }
+        record.attributes = parsed.combat().attributes;
+        record.vampyreTier = static_cast<uint32_t>(parsed.combat().vampyreTier);
+    }
+    return record;
+}
+
+template <typename T>
+void appendTable(std::string& out, uint64_t& offset, const std::vector<T>& rows) {
+    out.resize((out.size() + 7) & ~size_t(7), '\0');
+    offset = out.size();
+    out.append(reinterpret_cast<const char*>(rows.data()), rows.size() * sizeof(T));
+}
+}
+
+std::string binarydb::compile(const json& items, const json& prices, const std::vector<json>& monsterSources) {
+    StringTable strings;
+
+    std::vector<ItemRecord> itemRows;
+    if (items.is_object()) {
+        for (auto& [idStr, item] : items.items()) {
+            int id;
+            if (!item.is_object() || !item.contains("equipment") || !item["equipment"].is_object()) continue;
+            if (!parseId(idStr, id)) continue;
+            itemRows.push_back(compileItem(id, item, strings));
+        }
+    }
+    std::sort(itemRows.begin(), itemRows.end(),
+              [](const ItemRecord& a, const ItemRecord& b) { return a.id < b.id; });
+
+    std::vector<MonsterRecord> monsterRows;
+    for (uint32_t source = 0; source < monsterSources.size(); ++source) {
+        const json& root = monsterSources[source];
+        if (!root.is_array() && !root.is_object()) continue;
+        for (const auto& monster : root) {
+            if (monster.is_object()) monsterRows.push_back(compileMonster(source, root.is_array(), monster, strings));
+        }
+    }
+
+    std::vector<PriceRecord> priceRows;
+    auto data = prices.find("data");
+    if (prices.is_object() && data != prices.end() && data->is_object()) {
+        for (auto& [idStr, price] : data->items()) {
+            int id;
+            if (!price.is_object() || !parseId(idStr, id)) continue;
+            priceRows.push_back({id, intOr(price, "high", 0), intOr(price, "low", 0)});
+        }
+    }
+    std::sort(priceRows.begin(), priceRows.end(),
+              [](const PriceRecord& a, const PriceRecord& b) { return a.id < b.id; });
+
+    Header header {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrderMark;
+    header.itemStatCount = kItemStatCount;
+    header.itemCount = static_cast<uint32_t>(itemRows.size());
+    header.monsterCount = static_cast<uint32_t>(monsterRows.size());
+    header.priceCount = static_cast<uint32_t>(priceRows.size());
+
+    std::string out(sizeof(Header), '\0');
+    appendTable(out, header.itemsOffset, itemRows);
+    appendTable(out, header.monstersOffset, monsterRows);
+    appendTable(out, header.pricesOffset, priceRows);
+    appendTable(out, header.stringsOffset, std::vector<char>(strings.blob().begin(), strings.blob().end()));
+    header.stringsSize = strings.blob().size();
+    std::memcpy(&out[0], &header, sizeof(Header));
+    return out;
+}
+
+bool BinaryDb::open(const std::string& path) {
+    close();
+#ifndef __EMSCRIPTEN__
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Could not open database: " << path << "\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        std::cerr << "Database is empty: " << path << "\n";
+        return false;
+    }
+    void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Could not map database: " << path << "\n";
+        return false;
+    }
+    data_ = static_cast<const char*>(mapping);
+    size_ = static_cast<size_t>(st.st_size);
+    mapped_ = true;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Could not open database: " << path << "\n";
+        return false;
+    }
+    owned_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = owned_.data();
+    size_ = owned_.size();
+#endif
+    if (validate()) {
+        buildItems();
+        return true;
+    }
+    std::cerr << "Ignoring database " << path << "; rebuild it with osrsdb\n";
+    close();
+    return false;
+}
+
+bool BinaryDb::load(std::string contents) {
+    close();
+    owned_ = std::move(contents);
+    data_ = owned_.data();
+    size_ = owned_.size();
+    if (validate()) {
+        buildItems();
+        return true;
+    }
+    close();
+    return false;
+}
+
+void BinaryDb::close() {
+#ifndef __EMSCRIPTEN__
+    if (mapped_) munmap(const_cast<char*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    owned_.clear();
+    items_.clear();
+}
+
+bool BinaryDb::validate() {
+    if (size_ < sizeof(Header)) {
+        std::cerr << "Database is truncated\n";
+        return false;
+    }
+    const Header& h = *header();
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "Not an OSRS database\n";
+        return false;
+    }
+    if (h.version != kVersion || h.byteOrder != kByteOrderMark || h.itemStatCount != kItemStatCount) {
+        std::cerr << "Database format " << h.version << " does not match this build (" << kVersion << ")\n";
+        return false;
+    }
+    auto fits = [&](uint64_t offset, uint64_t bytes) {
+        return offset % 8 == 0 && offset <= size_ && bytes <= size_ - offset;
+    };
+    if (!fits(h.itemsOffset, uint64_t(h.itemCount) * sizeof(ItemRecord)) ||
+        !fits(h.monstersOffset, uint64_t(h.monsterCount) * sizeof(MonsterRecord)) ||
+        !fits(h.pricesOffset, uint64_t(h.priceCount) * sizeof(PriceRecord)) ||
+        !fits(h.stringsOffset, h.stringsSize)) {
+        std::cerr << "Database is truncated\n";
+        return false;
+    }
+    return true;
+}
+
+std::string_view BinaryDb::str(StringRef ref) const {
+    const Header& h = *header();
+    if (uint64_t(ref.offset) + ref.length > h.stringsSize) return {};
+    return std::string_view(data_ + h.stringsOffset + ref.offset, ref.length);
+}
+
+const ItemRecord* BinaryDb::findItem(int id) const {
+    if (!isOpen()) return nullptr;
+    const ItemRecord* first = &itemAt(0);
+    const ItemRecord* last = first + itemCount();
+    const ItemRecord* it = std::lower_bound(first, last, id,
+                                            [](const ItemRecord& r, int key) { return r.id < key; });
+    return (it != last && it->id == id) ? it : nullptr;
+}
+
+const PriceRecord* BinaryDb::findPrice(int id) const {
+    if (!isOpen()) return nullptr;
+    const PriceRecord* first = reinterpret_cast<const PriceRecord*>(data_ + header()->pricesOffset);
+    const PriceRecord* last = first + priceCount();
+    const PriceRecord* it = std::lower_bound(first, last, id,
+                                             [](const PriceRecord& r, int key) { return r.id < key; });
+    return (it != last && it->id == id) ? it : nullptr;
+}
+
+void BinaryDb::buildItems() {
+    for (size_t i = 0; i < itemCount(); ++i) items_.add(makeItem(itemAt(i)));
+}
+
+Item BinaryDb::makeItem(const ItemRecord& record) const {
+    ItemTraits traits {record.effects, static_cast<WeaponClass>(record.weaponClass),
+                       static_cast<AmmoClass>(record.ammoClass)};
+    Item item(record.id, std::string(str(record.name)), std::string(str(record.slot)),
+              std::string(str(record.weaponType)), traits);
+    for (int i = 0; i < kItemStatCount; ++i) item.setStat(static_cast<ItemStat>(i), record.stats[i]);
+    return item;
+}
+
+bool BinaryDb::loadMonster(const std::string& name, Monster& out) const {
+    // An exact match that leaves the monster without hitpoints is kept, but
+    // later sources are still searched, as main falls back to the bosses file
+    bool found = false;
+    uint32_t foundSource = 0;
+    for (size_t i = 0; i < monsterCount(); ++i) {
+        const MonsterRecord& record = monsterAt(i);
+        if (found && record.source <= foundSource) continue;
+        std::string_view recordName = str(record.name);
+        if (record.flags & kMonsterPrefixMatch) {
+            if (recordName.compare(0, name.size(), name) != 0) continue;
+            bool hasHitpoints = (record.present >> Hitpoints) & 1u;
+            if (!hasHitpoints || record.fields[Hitpoints] <= 0) continue;
+        } else if (recordName != name) {
+            continue;
+        }
+
+        for (int f = 0; f < kMonsterFieldCount; ++f) {
+            if ((record.present >> f) & 1u) out.setInt(kMonsterFieldKeys[f], record.fields[f]);
+        }
+        if (record.attributes) {
+            out.clearAttributes();
+            for (int a = 0; a < kMonsterAttributeCount; ++a) {
+                if (!((record.attributes >> a) & 1u)) continue;
+                auto attr = static_cast<MonsterAttribute>(a);
+                std::string attrName = monsterAttributeName(attr);
+                if (attr == MonsterAttribute::Vampyre && record.vampyreTier) attrName += std::to_string(record.vampyreTier);
+                out.addAttribute(attrName);
+            }
+        }
+        if (out.getCurrentHP() > 0) return true;
+        found = true;
+        foundSource = record.source;
+    }
+    return found;
+}
@@ -0,0 +1,120 @@
+// damage_table.cpp
+#include "damage_table.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Damage range of roll h of an attack
+void rollRange(const AttackShape& shape, int h, int& lo, int& hi) {
+    int rollMax = shape.maxHit;
+    if (h == 1) rollMax = shape.maxHit / 2;
+    else if (h == 2) rollMax = shape.maxHit / 4;
+    
+    lo = 0;
+    hi = rollMax;
+    if (shape.fang) {
+        lo = static_cast<int>(rollMax * 0.15);
+        hi = static_cast<int>(rollMax * 0.85);
+        if (lo > hi) lo = hi;
+    }
+}
+
+int clampedHits(const AttackShape& shape) {
+    return std::max(1, std::min(3, shape.hits));
+}
+
+} // namespace
+
+double DamageTable::expectedDamage(const AttackShape& shape) {
+    double total = 0.0;
+    for (int h = 0; h < clampedHits(shape); ++h) {
+        int lo, hi;
+        rollRange(shape, h, lo, hi);
+        double roll = shape.accuracy * (lo + hi) * 0.5;
+        if (h == 0 && shape.kerisCrit) roll *= (53.0 / 51.0);
+        total += roll;
+    }
+    return total;
+}
+
+DamageTable::DamageTable(const AttackShape& shape) {
+    double chance = std::max(0.0, std::min(1.0, shape.accuracy));
+    
+    // Single roll: miss with (1 - chance), otherwise uniform over the damage range
+    auto rollPMF = [&](int h) {
+        int lo, hi;
+        rollRange(shape, h, lo, hi);
+        bool keris = (h == 0 && shape.kerisCrit);
+        
+        std::vector<double> pmf((keris ? hi * 3 : hi) + 1, 0.0);
+        pmf[0] += 1.0 - chance;
+        double each = chance / (hi - lo + 1);
+        for (int d = lo; d <= hi; ++d) {
+            if (keris) {
+                pmf[d] += each * (50.0 / 51.0);
+                pmf[d * 3] += each * (1.0 / 51.0);
+            } else {
+                pmf[d] += each;
+            }
+        }
+        return pmf;
+    };
+    
+    pmf_ = rollPMF(0);
+    
+    // Extra rolls (scythe) are independent, so the attack is their convolution
+    for (int h = 1; h < clampedHits(shape); ++h) {
+        std::vector<double> roll = rollPMF(h);
+        std::vector<double> out(pmf_.size() + roll.size() - 1, 0.0);
+        for (size_t i = 0; i < pmf_.size(); ++i) {
+            if (pmf_[i] == 0.0) continue;
+            for (size_t j = 0; j < roll.size(); ++j) {
+                out[i + j] += pmf_[i] * roll[j];
+            }
+        }
+        pmf_.swap(out);
+    }
+    
+    mean_ = 0.0;
+    for (size_t d = 0; d < pmf_.size(); ++d) mean_ += d * pmf_[d];
+    
+    // Vose's alias method
+    size_t n = pmf_.size();
+    accept_.assign(n, 1u << 24);
+    alias_.resize(n);
+    
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    small.reserve(n);
+    large.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = pmf_[i] * n;
+        alias_[i] = static_cast<uint32_t>(i);
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+    
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+        
+        // A column that can occur keeps at least one threshold step, so rare
+        // hits never round away while the simulators wait for them
+        uint32_t keep = static_cast<uint32_t>(std::llround(scaled[s] * 16777216.0));
+        accept_[s] = pmf_[s] > 0.0 ? std::max(keep, 1u) : keep;
+        alias_[s] = l;
+        
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Leftovers are 1.0 up to rounding and keep their own column
+    
+    canDamage_ = false;
+    for (size_t c = 0; c < n; ++c) {
+        if ((c > 0 && accept_[c] > 0) || (accept_[c] < (1u << 24) && alias_[c] > 0)) canDamage_ = true;
+    }
+}
@@ -1,33 +1,97 @@
 // item.cpp
 #include "item.h"
+#include "fingerprint.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 
 using json = nlohmann::json;
 
+namespace {
+// Indexed by ItemStat
+const char* const kStatKeys[kItemStatCount] = {
+    "attack_stab", "attack_slash", "attack_crush", "attack_magic", "attack_ranged",
+    "defence_stab", "defence_slash", "defence_crush", "defence_magic", "defence_ranged",
+    "melee_strength", "ranged_strength", "magic_damage", "prayer",
+    "strength_bonus",
+    "attack_speed"
+};
+}
+
+const char* itemStatKey(ItemStat stat) {
+    return kStatKeys[static_cast<int>(stat)];
+}
+
+int itemStatIndex(const std::string& key) {
+    for (int i = 0; i < kItemStatCount; ++i) {
+        if (key == kStatKeys[i]) return i;
+    }
+    return -1;
+}
+
 Item::Item(std::string n) : name_(std::move(n)), id_(-1), price_(0) {}
 Item::Item(int id) : id_(id), name_(""), price_(0) {}
+Item::Item(int id, std::string name, std::string slot, std::string weaponType, const ItemTraits& traits)
+    : id_(id), name_(std::move(name)), slot_(std::move(slot)), weaponType_(std::move(weaponType)),
+      traits_(traits), traitsResolved_(true) {}
 
-void Item::parseItemJSON(const json& item) {
-    if (item.contains("equipment")) {
-        auto itemStats = item["equipment"];
-        for (auto& [key, value] : itemStats.items()) {
-            if (value.is_number_integer()) {
-                stats_int_[key] = value.get<int>();
-            } else if (value.is_string()) {
-                stats_str_[key] = value.get<std::string>();
-            } else if (value.is_boolean()) {
-                stats_bool_[key] = value.get<bool>();
-            }
-        }
+void Item::resolveTraits() const {
+    traits_ = ItemEffectRegistry::instance().lookup(id_, name_, weaponType_);
+    traitsResolved_ = true;
+}
+
+void Item::setInt(const std::string& key, int value) {
+    int stat = itemStatIndex(key);
+    if (stat >= 0) stats_[stat] = value;
+    else stats_int_[key] = value;
+}
+
+void Item::setStr(const std::string& key, const std::string& value) {
+    if (key == "slot") slot_ = value;
+    else if (key == "weapon_type") {
+        weaponType_ = value;
+        if (traitsResolved_) traits_.weaponClass = ItemEffectRegistry::classifyWeapon(name_, weaponType_);
     }
-    if (item.contains("weapon")) {
-        auto itemDetails = item["weapon"];
-        for (auto& [key, value] : itemDetails.items()) {
+    else stats_str_[key] = value;
+}
+
+int Item::getInt(const std::string& key) const {
+    int stat = itemStatIndex(key);
+    if (stat >= 0) return stats_[stat];
+    auto it = stats_int_.find(key);
+    return (it != stats_int_.end()) ? it->second : 0;
+}
+
+std::string Item::getStr(const std::string& key) const {
+    if (key == "slot") return slot_;
+    if (key == "weapon_type") return weaponType_;
+    auto it = stats_str_.find(key);
+    return (it != stats_str_.end()) ? it->second : "";
+}
+
+uint64_t Item::fingerprint() const {
+    uint64_t h = hashString(name_, mix64(static_cast<uint64_t>(id_)));
+    for (int stat : stats_) h = mix64(h ^ static_cast<uint32_t>(stat));
+    return hashString(weaponType_, hashString(slot_, h));
+}
+
+bool Item::operator==(const Item& other) const {
+    return id_ == other.id_ && name_ == other.name_ && price_ == other.price_ &&
+           std::equal(std::begin(stats_), std::end(stats_), std::begin(other.stats_)) &&
+           slot_ == other.slot_ && weaponType_ == other.weaponType_ &&
+           stats_int_ == other.stats_int_ && stats_str_ == other.stats_str_ && stats_bool_ == other.stats_bool_;
+}
+
+void Item::parseItemJSON(const json& item) {
+    // Known keys go straight to their slot through setInt/setStr
+    for (const char* section : {"equipment", "weapon"}) {
+        auto it = item.find(section);
+        if (it == item.end()) continue;
+        for (auto& [key, value] : it->items()) {
             if (value.is_number_integer()) {
-                stats_int_[key] = value.get<int>();
+                setInt(key, value.get<int>());
             } else if (value.is_string()) {
-                stats_str_[key] = value.get<std::string>();
+                setStr(key, value.get<std::string>());
             } else if (value.is_boolean()) {
                 stats_bool_[key] = value.get<bool>();
             }
@@ -42,6 +106,7 @@ void Item::fetchStats(int id, const json& allItems) {
         name_ = item.value("name", name_);
         id_ = id;
         parseItemJSON(item);
+        traitsResolved_ = false;
     }
 }
 
@@ -66,6 +131,7 @@ void Item::fetchStats(const std::string &filepath) {
             auto item = items[id_str];
             name_ = item.value("name", name_);
             parseItemJSON(item);
+            traitsResolved_ = false;
             return;
         }
     }
@@ -76,6 +142,7 @@ void Item::fetchStats(const std::string &filepath) {
                 id_ = std::stoi(key);
             } catch (...) {}
             parseItemJSON(item);
+            traitsResolved_ = false;
             break;
         }
     }
@@ -0,0 +1,15 @@
+// item_arena.cpp
+#include "item_arena.h"
+
+ItemHandle ItemArena::add(Item item) {
+    items_.push_back(std::move(item));
+    items_.back().traits(); // Resolved before get() readers share it
+    ItemHandle handle = static_cast<ItemHandle>(items_.size());
+    byId_.emplace(items_.back().getID(), handle);
+    return handle;
+}
+
+void ItemArena::clear() {
+    items_.clear();
+    byId_.clear();
+}
@@ -0,0 +1,156 @@
+// item_effects.cpp
+#include "item_effects.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+// An item gets the effect when its name contains every listed fragment
+struct EffectRule {
+    ItemEffect effect;
+    const char* fragments[2];
+    bool endsName = false;  // First fragment ends the name, before any "(...)"
+};
+
+const EffectRule kRules[] = {
+    {ItemEffect::OsmumtensFang, {"Osmumten's fang"}},
+    {ItemEffect::DragonHunterLance, {"Dragon hunter lance"}},
+    {ItemEffect::DragonHunterCrossbow, {"Dragon hunter crossbow"}},
+    {ItemEffect::Arclight, {"Arclight"}},
+    {ItemEffect::Arclight, {"Emberlight"}},
+    {ItemEffect::Keris, {"Keris"}},
+    {ItemEffect::KerisBreaching, {"Keris", "breaching"}},
+    {ItemEffect::LeafBladed, {"Leaf-bladed"}},
+    {ItemEffect::ScytheOfVitur, {"Scythe of vitur"}},
+    {ItemEffect::TwistedBow, {"Twisted bow"}},
+    {ItemEffect::DharokGreataxe, {"Dharok's greataxe"}},
+    {ItemEffect::ObsidianWeapon, {"Toktz-xil"}},
+    {ItemEffect::ObsidianWeapon, {"Tzhaar-ket"}},
+
+    {ItemEffect::Salve, {"Salve amulet"}},
+    {ItemEffect::SalveE, {"Salve amulet", "(e)"}},
+    {ItemEffect::SalveI, {"Salve amulet", "(i)"}},
+    {ItemEffect::SalveEI, {"Salve amulet", "(ei)"}},
+
+    // Every colour and ornament kit of the helmet, and charged black masks,
+    // but not other items named after them
+    {ItemEffect::SlayerHelm, {"Slayer helmet"}, true},
+    {ItemEffect::SlayerHelm, {"slayer helmet"}, true},
+    {ItemEffect::SlayerHelm, {"Black mask"}, true},
+    {ItemEffect::SlayerHelmI, {"Slayer helmet", "(i)"}, true},
+    {ItemEffect::SlayerHelmI, {"slayer helmet", "(i)"}, true},
+    {ItemEffect::SlayerHelmI, {"Black mask", "(i)"}, true},
+
+    {ItemEffect::VoidMeleeHelm, {"Void melee helm"}},
+    {ItemEffect::VoidRangerHelm, {"Void ranger helm"}},
+    {ItemEffect::VoidMageHelm, {"Void mage helm"}},
+    {ItemEffect::VoidTop, {"Void knight top"}},
+    {ItemEffect::EliteVoidTop, {"Elite void top"}},
+    {ItemEffect::VoidRobe, {"Void knight robe"}},
+    {ItemEffect::EliteVoidRobe, {"Elite void robe"}},
+    {ItemEffect::VoidGloves, {"Void knight gloves"}},
+
+    {ItemEffect::CrystalHelm, {"Crystal helm"}},
+    {ItemEffect::CrystalBody, {"Crystal body"}},
+    {ItemEffect::CrystalLegs, {"Crystal legs"}},
+    {ItemEffect::InquisitorHelm, {"Inquisitor's great helm"}},
+    {ItemEffect::InquisitorBody, {"Inquisitor's hauberk"}},
+    {ItemEffect::InquisitorLegs, {"Inquisitor's plateskirt"}},
+    {ItemEffect::ObsidianHelm, {"Obsidian helmet"}},
+    {ItemEffect::ObsidianBody, {"Obsidian platebody"}},
+    {ItemEffect::ObsidianLegs, {"Obsidian platelegs"}},
+    {ItemEffect::DharokHelm, {"Dharok's helm"}},
+    {ItemEffect::DharokBody, {"Dharok's platebody"}},
+    {ItemEffect::DharokLegs, {"Dharok's platelegs"}},
+};
+
+// Ammo classes each weapon class takes stats from, bit per AmmoClass
+constexpr unsigned ammoBit(AmmoClass ammo) { return 1u << static_cast<int>(ammo); }
+constexpr unsigned kAmmoAccepted[] = {
+    0,                                                        // Other
+    ammoBit(AmmoClass::Arrow),                                // Bow
+    ammoBit(AmmoClass::Bolt) | ammoBit(AmmoClass::BoltRack),  // Crossbow
+    ammoBit(AmmoClass::BoltRack),                             // KarilsCrossbow
+    ammoBit(AmmoClass::Javelin),                              // Ballista
+};
+
+// Case-insensitive search for a lowercase part
+bool containsNoCase(const std::string& s, const char* part) {
+    auto it = std::search(s.begin(), s.end(), part, part + std::strlen(part),
+                          [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+    return it != s.end();
+}
+
+bool matches(const EffectRule& rule, const std::string& name) {
+    for (const char* part : rule.fragments) {
+        if (part && name.find(part) == std::string::npos) return false;
+    }
+    if (rule.endsName) {
+        size_t end = name.find(rule.fragments[0]) + std::strlen(rule.fragments[0]);
+        if (end != name.size() && name.compare(end, 2, " (") != 0) return false;
+    }
+    return true;
+}
+}
+
+bool ammoCompatible(WeaponClass weapon, AmmoClass ammo) {
+    return (kAmmoAccepted[static_cast<int>(weapon)] >> static_cast<int>(ammo)) & 1u;
+}
+
+ItemEffectRegistry& ItemEffectRegistry::instance() {
+    static ItemEffectRegistry registry;
+    return registry;
+}
+
+ItemEffects ItemEffectRegistry::matchName(const std::string& name) {
+    ItemEffects effects = 0;
+    if (name.empty()) return effects;
+    for (const EffectRule& rule : kRules) {
+        if (matches(rule, name)) effects |= effectBit(rule.effect);
+    }
+    return effects;
+}
+
+WeaponClass ItemEffectRegistry::classifyWeapon(const std::string& name, const std::string& weaponType) {
+    if (weaponType == "bow") {
+        if (containsNoCase(name, "crystal bow") || containsNoCase(name, "faerdhinen")) return WeaponClass::Other;
+        return WeaponClass::Bow;
+    }
+    if (weaponType == "crossbow") {
+        if (containsNoCase(name, "ballista")) return WeaponClass::Ballista;
+        if (containsNoCase(name, "karil")) return WeaponClass::KarilsCrossbow;
+        return WeaponClass::Crossbow;
+    }
+    return WeaponClass::Other;
+}
+
+AmmoClass ItemEffectRegistry::classifyAmmo(const std::string& name) {
+    if (containsNoCase(name, "bolt rack")) return AmmoClass::BoltRack;
+    if (containsNoCase(name, "bolt")) return AmmoClass::Bolt;
+    if (containsNoCase(name, "arrow")) return AmmoClass::Arrow;
+    if (containsNoCase(name, "javelin")) return AmmoClass::Javelin;
+    return AmmoClass::None;
+}
+
+void ItemEffectRegistry::indexItemDb(const json& itemDb) {
+    for (auto& [idStr, item] : itemDb.items()) {
+        if (!item.is_object() || !item.contains("equipment")) continue;
+        int id;
+        try {
+            id = std::stoi(idStr);
+        } catch (...) {
+            continue;
+        }
+        std::string name = item.value("name", "");
+        std::string weaponType;
+        auto weapon = item.find("weapon");
+        if (weapon != item.end() && weapon->is_object()) weaponType = weapon->value("weapon_type", "");
+        byId_[id] = {matchName(name), classifyWeapon(name, weaponType), classifyAmmo(name)};
+    }
+}
+
+ItemTraits ItemEffectRegistry::lookup(int id, const std::string& name, const std::string& weaponType) const {
+    auto it = byId_.find(id);
+    if (it != byId_.end()) return it->second;
+    return {matchName(name), classifyWeapon(name, weaponType), classifyAmmo(name)};
+}
@@ -0,0 +1,164 @@
+// loadout.cpp
+#include "loadout.h"
+#include <array>
+
+namespace {
+const char* const kSlotNames[kGearSlotCount] = {
+    "head", "cape", "neck", "ammo", "weapon", "shield", "body", "legs", "hands", "feet", "ring"
+};
+
+// A set is complete when every piece slot holds an item with one of the
+// piece's accepted effects
+struct SetPiece {
+    GearSlot slot;
+    ItemEffects accepts;
+};
+
+struct SetDefinition {
+    const char* name;
+    int pieceCount;
+    SetPiece pieces[4];
+};
+
+constexpr ItemEffects kVoidTops = effectBit(ItemEffect::VoidTop) | effectBit(ItemEffect::EliteVoidTop);
+constexpr ItemEffects kVoidRobes = effectBit(ItemEffect::VoidRobe) | effectBit(ItemEffect::EliteVoidRobe);
+
+// Indexed by GearSet
+const SetDefinition kSets[kGearSetCount] = {
+    {"Elite Void Melee", 4, {{GearSlot::Head, effectBit(ItemEffect::VoidMeleeHelm)},
+                             {GearSlot::Body, effectBit(ItemEffect::EliteVoidTop)},
+                             {GearSlot::Legs, effectBit(ItemEffect::EliteVoidRobe)},
+                             {GearSlot::Hands, effectBit(ItemEffect::VoidGloves)}}},
+    {"Void Melee", 4, {{GearSlot::Head, effectBit(ItemEffect::VoidMeleeHelm)},
+                       {GearSlot::Body, kVoidTops},
+                       {GearSlot::Legs, kVoidRobes},
+                       {GearSlot::Hands, effectBit(ItemEffect::VoidGloves)}}},
+    {"Elite Void Range", 4, {{GearSlot::Head, effectBit(ItemEffect::VoidRangerHelm)},
+                             {GearSlot::Body, effectBit(ItemEffect::EliteVoidTop)},
+                             {GearSlot::Legs, effectBit(ItemEffect::EliteVoidRobe)},
+                             {GearSlot::Hands, effectBit(ItemEffect::VoidGloves)}}},
+    {"Void Range", 4, {{GearSlot::Head, effectBit(ItemEffect::VoidRangerHelm)},
+                       {GearSlot::Body, kVoidTops},
+                       {GearSlot::Legs, kVoidRobes},
+                       {GearSlot::Hands, effectBit(ItemEffect::VoidGloves)}}},
+    {"Elite Void Mage", 4, {{GearSlot::Head, effectBit(ItemEffect::VoidMageHelm)},
+                            {GearSlot::Body, effectBit(ItemEffect::EliteVoidTop)},
+                            {GearSlot::Legs, effectBit(ItemEffect::EliteVoidRobe)},
+                            {GearSlot::Hands, effectBit(ItemEffect::VoidGloves)}}},
+    {"Void Mage", 4, {{GearSlot::Head, effectBit(ItemEffect::VoidMageHelm)},
+                      {GearSlot::Body, kVoidTops},
+                      {GearSlot::Legs, kVoidRobes},
+                      {GearSlot::Hands, effectBit(ItemEffect::VoidGloves)}}},
+    {"Crystal", 3, {{GearSlot::Head, effectBit(ItemEffect::CrystalHelm)},
+                    {GearSlot::Body, effectBit(ItemEffect::CrystalBody)},
+                    {GearSlot::Legs, effectBit(ItemEffect::CrystalLegs)}}},
+    {"Inquisitor", 3, {{GearSlot::Head, effectBit(ItemEffect::InquisitorHelm)},
+                       {GearSlot::Body, effectBit(ItemEffect::InquisitorBody)},
+                       {GearSlot::Legs, effectBit(ItemEffect::InquisitorLegs)}}},
+    {"Obsidian", 3, {{GearSlot::Head, effectBit(ItemEffect::ObsidianHelm)},
+                     {GearSlot::Body, effectBit(ItemEffect::ObsidianBody)},
+                     {GearSlot::Legs, effectBit(ItemEffect::ObsidianLegs)}}},
+    {"Dharok", 4, {{GearSlot::Head, effectBit(ItemEffect::DharokHelm)},
+                   {GearSlot::Body, effectBit(ItemEffect::DharokBody)},
+                   {GearSlot::Legs, effectBit(ItemEffect::DharokLegs)},
+                   {GearSlot::Weapon, effectBit(ItemEffect::DharokGreataxe)}}},
+};
+
+// Set pieces that go in one slot
+struct SlotPiece {
+    uint8_t set;
+    uint8_t bit;
+    ItemEffects accepts;
+};
+
+struct SlotPieces {
+    SlotPiece pieces[kGearSetCount];
+    int count {0};
+};
+
+const SlotPieces* piecesBySlot() {
+    static const auto table = [] {
+        std::array<SlotPieces, kGearSlotCount> bySlot {};
+        for (int set = 0; set < kGearSetCount; ++set) {
+            for (int i = 0; i < kSets[set].pieceCount; ++i) {
+                const SetPiece& piece = kSets[set].pieces[i];
+                SlotPieces& slot = bySlot[static_cast<int>(piece.slot)];
+                slot.pieces[slot.count++] = {static_cast<uint8_t>(set), static_cast<uint8_t>(1u << i), piece.accepts};
+            }
+        }
+        return bySlot;
+    }();
+    return table.data();
+}
+}
+
+int gearSlotIndex(const std::string& slot) {
+    if (slot == "2h") return static_cast<int>(GearSlot::Weapon);
+    for (int i = 0; i < kGearSlotCount; ++i) {
+        if (slot == kSlotNames[i]) return i;
+    }
+    return -1;
+}
+
+const char* gearSlotName(GearSlot slot) {
+    return kSlotNames[static_cast<int>(slot)];
+}
+
+const char* gearSetName(GearSet set) {
+    return set == GearSet::None ? "" : kSets[static_cast<int>(set)].name;
+}
+
+void GearSetTracker::update(GearSlot slot, const Item* item) {
+    const SlotPieces& slotPieces = piecesBySlot()[static_cast<int>(slot)];
+    if (slotPieces.count == 0) return;
+
+    ItemEffects effects = item ? item->getEffects() : 0;
+    bool changed = false;
+    for (int i = 0; i < slotPieces.count; ++i) {
+        const SlotPiece& piece = slotPieces.pieces[i];
+        uint8_t worn = (effects & piece.accepts) ? (worn_[piece.set] | piece.bit) : (worn_[piece.set] & ~piece.bit);
+        changed |= worn != worn_[piece.set];
+        worn_[piece.set] = worn;
+    }
+    if (!changed) return;
+
+    active_ = GearSet::None;
+    for (int set = 0; set < kGearSetCount; ++set) {
+        if (worn_[set] == (1u << kSets[set].pieceCount) - 1) {
+            active_ = static_cast<GearSet>(set);
+            break;
+        }
+    }
+}
+
+int GearSetTracker::pieces(GearSet set) const {
+    if (set == GearSet::None) return 0;
+    int count = 0;
+    for (uint8_t worn = worn_[static_cast<int>(set)]; worn; worn &= worn - 1) ++count;
+    return count;
+}
+
+void Loadout::set(GearSlot slot, const Item* item) {
+    const Item*& current = items_[static_cast<int>(slot)];
+    if (current) current->accumulateStats(bonus_, -1);
+    if (item) item->accumulateStats(bonus_, 1);
+    current = item;
+    sets_.update(slot, item);
+}
+
+void Loadout::wear(GearSlot slot, const Item* item) {
+    if (item && item->isTwoHanded()) {
+        set(GearSlot::Shield, nullptr);
+    } else if (item && slot == GearSlot::Shield) {
+        const Item* weapon = get(GearSlot::Weapon);
+        if (weapon && weapon->isTwoHanded()) set(GearSlot::Weapon, nullptr);
+    }
+    set(slot, item);
+}
+
+bool Loadout::hasEquipped(const char* itemName) const {
+    for (const Item* item : items_) {
+        if (item && item->getName() == itemName) return true;
+    }
+    return false;
+}
@@ -5,6 +5,7 @@
 #include "monster.h"
 #include "battle.h"
 #include "upgrade_advisor.h"
+#include "binary_db.h"
 #include "json.hpp"
 
 using json = nlohmann::json;
@@ -29,14 +30,25 @@ int main() {
 
         // 0. Load Databases
         std::cout << "[0/6] Loading Databases...\n";
-        std::cout << "      Loading items-complete.json... ";
-        json itemDb = loadJSON("data/items-complete.json");
-        std::cout << "Done (" << itemDb.size() << " items)\n";
-        
-        std::cout << "      Loading latest_prices.json... ";
-        json priceDb = loadJSON("data/latest_prices.json");
-        // prices are usually in "data" key
-        std::cout << "Done\n";
+        // The compiled database is mapped in place; without it, parse the JSON
+        BinaryDb db;
+        json itemDb;
+        json priceDb;
+        if (db.open("data/osrs.db")) {
+            std::cout << "      Mapped osrs.db (" << db.itemCount() << " items, " << db.monsterCount()
+                      << " monsters, " << db.priceCount() << " prices)\n";
+        } else {
+            std::cout << "      No data/osrs.db (build it with the 'database' target), reading JSON\n";
+            std::cout << "      Loading items-complete.json... ";
+            itemDb = loadJSON("data/items-complete.json");
+            ItemEffectRegistry::instance().indexItemDb(itemDb);
+            std::cout << "Done (" << itemDb.size() << " items)\n";
+            
+            std::cout << "      Loading latest_prices.json... ";
+            priceDb = loadJSON("data/latest_prices.json");
+            // prices are usually in "data" key
+            std::cout << "Done\n";
+        }
 
         // 1. Setup Player
         std::cout << "[1/6] Initializing Player 'WolpiXD'...\n";
@@ -54,27 +66,34 @@ int main() {
             for(int i=0; i<24; ++i) stats += mockStatLine;
         }
         player.parseStats(stats);
-        std::cout << "      Attack: " << player.getStat("Attack") << " | Strength: " << player.getStat("Strength") << "\n";
+        std::cout << "      Attack: " << player.getStat(Skill::Attack) << " | Strength: " << player.getStat(Skill::Strength) << "\n";
 
         // 3. Fetch Gear
         std::cout << "[3/6] Fetching Gear from WikiSync...\n";
         player.fetchGearFromClient();
         
         std::cout << "      Loading Gear Stats from DB...\n";
-        player.loadGearStats(itemDb);
+        if (db.isOpen()) player.loadGearStats(db);
+        else player.loadGearStats(itemDb);
         
         // 4. Setup Monster
         std::string monsterName = "Vorkath (Post-quest)";
         std::cout << "[4/6] Initializing Monster '" << monsterName << "'...\n";
         Monster monster(monsterName); 
         
-        // Try loading from standard DB
-        monster.loadFromJSON("data/monsters-nodrops.json");
-        
-        // If not found (HP is 0), try bosses DB
-        if (monster.getCurrentHP() == 0) {
-             std::cout << "      Not found in standard DB, checking bosses DB...\n";
-             monster.loadFromJSON("data/bosses_complete.json");
+        if (db.isOpen()) {
+            // Compiled from both files below, searched in the same order,
+            // including the fallback when the first match has no HP
+            db.loadMonster(monsterName, monster);
+        } else {
+            // Try loading from standard DB
+            monster.loadFromJSON("data/monsters-nodrops.json");
+            
+            // If not found (HP is 0), try bosses DB
+            if (monster.getCurrentHP() == 0) {
+                 std::cout << "      Not found in standard DB, checking bosses DB...\n";
+                 monster.loadFromJSON("data/bosses_complete.json");
+            }
         }
         
         // Verification check
@@ -83,24 +102,36 @@ int main() {
         } else {
             std::cerr << "      Warning: '" << monsterName << "' not found. Defaulting to 'Goblin'.\n";
             monster = Monster("Goblin");
-            monster.loadFromJSON("data/monsters-nodrops.json");
+            if (db.isOpen()) db.loadMonster("Goblin", monster);
+            else monster.loadFromJSON("data/monsters-nodrops.json");
         }
 
         // 5. Battle
         std::cout << "[5/6] Starting Battle Simulation...\n";
         Battle battle(player, monster);
         battle.optimizeAttackStyle();
-        battle.runSimulations(10000);
+        TTKDistribution ttk = battle.solveTTK();
         
         std::cout << "      Debug: Accuracy=" << battle.getHitChance()
                   << " | Max Hit=" << battle.getMaxHit() << "\n";
+        if (ttk.killable) {
+            const char* approx = ttk.percentilesExact ? "" : "~";
+            std::cout << "      TTK: avg " << std::fixed << std::setprecision(1) << ttk.expectedSeconds << "s"
+                      << " | p50 " << approx << ttk.p50Ticks * 0.6 << "s"
+                      << " | p90 " << approx << ttk.p90Ticks * 0.6 << "s"
+                      << " | p99 " << approx << ttk.p99Ticks * 0.6 << "s\n";
+            std::cout.unsetf(std::ios::floatfield);
+            std::cout << std::setprecision(6);
+        }
 
         // 6. Upgrade Advisor
         std::cout << "\n[6/6] Generating Next Best Item Suggestions...\n";
-        if (priceDb.empty() || itemDb.empty()) {
+        bool haveDbs = db.isOpen() ? (db.itemCount() > 0 && db.priceCount() > 0) : !(priceDb.empty() || itemDb.empty());
+        if (!haveDbs) {
              std::cerr << "Cannot run Advisor: Missing Item or Price DB.\n";
         } else {
-            UpgradeAdvisor advisor(player, monster, itemDb, priceDb);
+            UpgradeAdvisor advisor = db.isOpen() ? UpgradeAdvisor(player, monster, db)
+                                                 : UpgradeAdvisor(player, monster, itemDb, priceDb);
             auto suggestions = advisor.suggestUpgrades();
 
             // Split into Singles and Duos
@@ -2,19 +2,82 @@
 #include "monster.h"
 #include <iostream>
 #include <fstream>
+#include <utility>
 #include "json.hpp"
+#include "fingerprint.h"
 
 using json = nlohmann::json;
 
+namespace {
+// Indexed by MonsterAttribute
+const char* const kAttributeNames[kMonsterAttributeCount] = {
+    "demon", "dragon", "fiery", "golem", "kalphite", "leafy", "penance", "rat", "shade", "spectral",
+    "undead", "vampyre", "xerician"
+};
+
+// Integer stats the loader keeps: what MonsterCombat and the UI read. The
+// binary database stores the same set (binary_db.cpp); examine text, wiki
+// links, drop and slayer metadata are skipped.
+const char* const kLoadedStats[] = {
+    "hitpoints", "combat_level", "attack_level", "strength_level", "defence_level", "magic_level",
+    "ranged_level", "max_hit", "attack_speed", "size", "defence_stab", "defence_slash", "defence_crush",
+    "defence_magic", "defence_ranged"
+};
+
+bool isLoadedStat(const std::string& key) {
+    for (const char* stat : kLoadedStats) {
+        if (key == stat) return true;
+    }
+    return false;
+}
+}
+
+int monsterAttributeIndex(const std::string& attr) {
+    if (attr.size() == 8 && attr.compare(0, 7, "vampyre") == 0 && attr[7] >= '1' && attr[7] <= '3') {
+        return static_cast<int>(MonsterAttribute::Vampyre);
+    }
+    for (int i = 0; i < kMonsterAttributeCount; ++i) {
+        if (attr == kAttributeNames[i]) return i;
+    }
+    return -1;
+}
+
+const char* monsterAttributeName(MonsterAttribute attr) {
+    return kAttributeNames[static_cast<int>(attr)];
+}
+
 Monster::Monster(std::string n) : name_(std::move(n)) {}
 
 void Monster::setInt(const std::string& key, int value) {
     stats_int_[key] = value;
+    updateCombat(key, value);
+}
+
+void Monster::updateCombat(const std::string& key, int value) {
+    static const std::pair<const char*, DefenceStyle> kDefenceKeys[] = {
+        {"defence_stab", DefenceStyle::Stab}, {"defence_slash", DefenceStyle::Slash},
+        {"defence_crush", DefenceStyle::Crush}, {"defence_ranged", DefenceStyle::Ranged},
+        {"defence_magic", DefenceStyle::Magic},
+    };
+
     if (key == "hitpoints") {
+        combat_.hitpoints = value;
         current_hp_ = value;
+    } else if (key == "size") {
+        combat_.size = value;
+    } else if (key == "magic_level") {
+        combat_.magicLevel = value;
+    } else if (key == "defence_level") {
+        combat_.defenceLevel = value;
+    } else if (key.compare(0, 8, "defence_") == 0) {
+        for (const auto& [name, style] : kDefenceKeys) {
+            if (key == name) combat_.defenceBonus[static_cast<int>(style)] = value;
+        }
+    } else {
+        return;
     }
-    if (key == "size") {
-        size_ = value;
+    for (int i = 0; i < kDefenceStyleCount; ++i) {
+        combat_.defenceRoll[i] = (combat_.defenceLevel + 9) * (combat_.defenceBonus[i] + 64);
     }
 }
 
@@ -34,16 +97,74 @@ bool Monster::getBool(const std::string& key) const {
 }
 
 void Monster::resetHP() {
-    current_hp_ = stats_int_.count("hitpoints") ? stats_int_.at("hitpoints") : 0;
+    current_hp_ = combat_.hitpoints;
+}
+
+void Monster::setStr(const std::string& key, const std::string& value) {
+    if (key != "attributes") {
+        stats_str_[key] = value;
+        return;
+    }
+    // Comma-separated list, e.g. "demon,fiery"
+    clearAttributes();
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(',', start);
+        if (end == std::string::npos) end = value.size();
+        size_t first = value.find_first_not_of(' ', start);
+        size_t last = value.find_last_not_of(' ', end - 1);
+        if (first < end && last != std::string::npos && last >= first) {
+            addAttribute(value.substr(first, last - first + 1));
+        }
+        start = end + 1;
+    }
+}
+
+void Monster::addAttribute(const std::string& attr) {
+    attributes_.push_back(attr);
+    int index = monsterAttributeIndex(attr);
+    if (index < 0) return;
+    combat_.attributes |= 1u << index;
+    if (index == static_cast<int>(MonsterAttribute::Vampyre) && attr.size() == 8) {
+        combat_.vampyreTier = static_cast<VampyreTier>(attr[7] - '0');
+    }
+}
+
+void Monster::clearAttributes() {
+    attributes_.clear();
+    combat_.attributes = 0;
+    combat_.vampyreTier = VampyreTier::None;
 }
 
 bool Monster::hasAttribute(const std::string& attr) const {
+    int index = monsterAttributeIndex(attr);
+    if (index == static_cast<int>(MonsterAttribute::Vampyre) && attr.size() == 8) {
+        return combat_.vampyreTier == static_cast<VampyreTier>(attr[7] - '0');
+    }
+    if (index >= 0) return hasAttribute(static_cast<MonsterAttribute>(index));
     for (const auto& a : attributes_) {
         if (a == attr) return true;
     }
     return false;
 }
 
+uint64_t Monster::fingerprint() const {
+    // XOR of per-entry keys, so map order does not matter
+    uint64_t h = zobristKey(FingerprintFeature::Monster, 0, hashString(name_));
+    h ^= zobristKey(FingerprintFeature::Monster, 1, static_cast<uint32_t>(combat_.size));
+    for (const auto& [key, value] : stats_int_) {
+        h ^= zobristKey(FingerprintFeature::MonsterInt, hashString(key), static_cast<uint32_t>(value));
+    }
+    for (const auto& [key, value] : stats_str_) {
+        h ^= zobristKey(FingerprintFeature::MonsterStr, hashString(key), hashString(value));
+    }
+    for (const auto& [key, value] : stats_bool_) {
+        h ^= zobristKey(FingerprintFeature::MonsterBool, hashString(key), value);
+    }
+    uint64_t attributes = combat_.attributes | (static_cast<uint64_t>(combat_.vampyreTier) << 32);
+    return h ^ zobristKey(FingerprintFeature::MonsterAttributes, 0, attributes);
+}
+
 void Monster::loadFromJSON(const std::string &filepath) {
     std::ifstream file(filepath);
     if (!file.is_open()) {
@@ -62,23 +183,12 @@ void Monster::loadFromJSON(const std::string &filepath) {
     auto loadStats = [&](const json& monster) {
         for (auto& [key, value] : monster.items()) {
             if (value.is_number_integer()) {
-                int v = value.get<int>();
-                stats_int_[key] = v;
-                if (key == "hitpoints") {
-                    current_hp_ = v;
-                }
-                if (key == "size") {
-                    size_ = v;
-                }
-            } else if (value.is_string()) {
-                stats_str_[key] = value.get<std::string>();
-            } else if (value.is_boolean()) {
-                stats_bool_[key] = value.get<bool>();
+                if (isLoadedStat(key)) setInt(key, value.get<int>());
             } else if (key == "attributes" && value.is_array()) {
-                attributes_.clear();
+                clearAttributes();
                 for (const auto& attr : value) {
                     if (attr.is_string()) {
-                        attributes_.push_back(attr.get<std::string>());
+                        addAttribute(attr.get<std::string>());
                     }
                 }
             }
@@ -2,6 +2,7 @@
 #include "player.h"
 #include <sstream>
 #include <vector>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -18,15 +19,46 @@
 #endif
 
 #include "json.hpp"
+#include "binary_db.h"
+#include "fingerprint.h"
 
 using json = nlohmann::json;
 
-std::string skills[24] {
+namespace {
+// Indexed by Skill
+const char* const kSkillNames[kSkillCount] = {
     "Overall", "Attack", "Defence", "Strength", "Hitpoints", "Ranged",
     "Prayer", "Magic", "Cooking", "Woodcutting", "Fletching", "Fishing",
     "Firemaking", "Crafting", "Smithing", "Mining", "Herblore", "Agility",
     "Thieving", "Slayer", "Farming", "Runecraft", "Hunter", "Construction"
 };
+}
+
+namespace {
+uint64_t levelKey(int skill, int level) {
+    return zobristKey(FingerprintFeature::Level, skill, static_cast<uint32_t>(level));
+}
+
+uint64_t gearKey(GearSlot slot, const Item& item) {
+    return zobristKey(FingerprintFeature::Gear, static_cast<uint64_t>(slot), item.fingerprint());
+}
+
+uint64_t hitpointsKey(int current, int max) {
+    return zobristKey(FingerprintFeature::Hitpoints, 0,
+                      (static_cast<uint64_t>(static_cast<uint32_t>(current)) << 32) | static_cast<uint32_t>(max));
+}
+}
+
+const char* skillName(Skill skill) {
+    return kSkillNames[static_cast<int>(skill)];
+}
+
+int skillIndex(const std::string& name) {
+    for (int i = 0; i < kSkillCount; ++i) {
+        if (name == kSkillNames[i]) return i;
+    }
+    return -1;
+}
 
 std::map<std::string, int> parseCSV(std::string csv_str) {
     std::map<std::string, int> res;
@@ -42,9 +74,9 @@ std::map<std::string, int> parseCSV(std::string csv_str) {
         std::getline(line_ss, level, ',');
         
         try {
-            res[skills[i]] = std::stoi(level);
+            res[kSkillNames[i]] = std::stoi(level);
         } catch (...) {
-            res[skills[i]] = 1;
+            res[kSkillNames[i]] = 1;
         }
         i++;
     }
@@ -54,154 +86,169 @@ std::map<std::string, int> parseCSV(std::string csv_str) {
 
 Player::Player(std::string n) : username(std::move(n)) {
     // Initialize default stats
-    for (const auto& skill : skills) {
-        stats_[skill] = 1;
-    }
-    currentHP_ = 99;
-    maxHP_ = 99;
-    piety_ = false;
-    rigour_ = false;
-    superCombat_ = false;
+    std::fill(std::begin(levels_), std::end(levels_), 1);
+    for (int i = 0; i < kSkillCount; ++i) fingerprint_ ^= levelKey(i, 1);
+    fingerprint_ ^= hitpointsKey(currentHP_, maxHP_);
+    updateBoosts();
 }
 
 void Player::parseStats(std::string raw_stats_response) {
     auto parsed = parseCSV(raw_stats_response);
     for (const auto& [key, value] : parsed) {
-        stats_[key] = value;
+        int index = skillIndex(key);
+        fingerprint_ ^= levelKey(index, levels_[index]) ^ levelKey(index, value);
+        levels_[index] = value;
+    }
+    setHP(getStat(Skill::Hitpoints), getStat(Skill::Hitpoints));
+    updateBoosts();
+}
+
+void Player::setStat(Skill skill, int level) {
+    int index = static_cast<int>(skill);
+    fingerprint_ ^= levelKey(index, levels_[index]) ^ levelKey(index, level);
+    levels_[index] = level;
+    updateBoosts();
+}
+
+void Player::setStat(const std::string& skill, int level) {
+    int index = skillIndex(skill);
+    if (index >= 0) setStat(static_cast<Skill>(index), level);
+}
+
+int Player::getStat(const std::string& skill) const {
+    int index = skillIndex(skill);
+    return index >= 0 ? levels_[index] : 0;
+}
+
+void Player::setSuperCombat(bool active) {
+    setFlag(superCombat_, 2, active);
+    updateBoosts();
+}
+
+void Player::setFlag(bool& flag, int index, bool active) {
+    if (flag != active) fingerprint_ ^= zobristKey(FingerprintFeature::Flag, index, 1);
+    flag = active;
+}
+
+void Player::setHP(int current, int max) {
+    fingerprint_ ^= hitpointsKey(currentHP_, maxHP_) ^ hitpointsKey(current, max);
+    currentHP_ = current;
+    maxHP_ = max;
+}
+
+void Player::updateBoosts() {
+    std::copy(std::begin(levels_), std::end(levels_), boosted_);
+    if (superCombat_) {
+        for (Skill skill : {Skill::Attack, Skill::Strength, Skill::Defence}) {
+            int base = levels_[static_cast<int>(skill)];
+            boosted_[static_cast<int>(skill)] = base + 5 + static_cast<int>(base * 0.15);
+        }
+    }
+}
+
+void Player::wear(GearSlot slot, const Item* item, std::shared_ptr<const Item> owned) {
+    if (const Item* current = getItem(slot)) {
+        current->accumulateStats(gearBonus_, -1);
+        fingerprint_ ^= gearKey(slot, *current);
+    }
+    if (item) {
+        item->accumulateStats(gearBonus_, 1);
+        fingerprint_ ^= gearKey(slot, *item);
     }
-    if (stats_.count("Hitpoints")) {
-        maxHP_ = stats_["Hitpoints"];
-        currentHP_ = maxHP_;
+    gear_[static_cast<int>(slot)] = item;
+    owned_[static_cast<int>(slot)] = std::move(owned);
+    gearSets_.update(slot, item);
+}
+
+void Player::equip(GearSlot slot, const Item& item) {
+    auto owned = std::make_shared<const Item>(item);
+    owned->traits(); // Resolved before copies of the player share it
+    const Item* worn = owned.get();
+    wear(slot, worn, std::move(owned));
+}
+
+void Player::equip(GearSlot slot, const ItemArena& items, ItemHandle item) {
+    wear(slot, item != kNoItem ? &items.get(item) : nullptr, nullptr);
+}
+
+void Player::unequip(GearSlot slot) {
+    wear(slot, nullptr, nullptr);
+}
+
+void Player::clearGear() {
+    for (int i = 0; i < kGearSlotCount; ++i) {
+        if (const Item* item = getItem(static_cast<GearSlot>(i))) fingerprint_ ^= gearKey(static_cast<GearSlot>(i), *item);
     }
+    std::fill(std::begin(gear_), std::end(gear_), nullptr);
+    std::fill(std::begin(owned_), std::end(owned_), nullptr);
+    std::fill(std::begin(gearBonus_), std::end(gearBonus_), 0);
+    gearSets_ = GearSetTracker();
 }
 
 void Player::equip(const std::string& slot, const Item& item) {
-    gear_[slot] = item;
+    int index = gearSlotIndex(slot);
+    if (index >= 0) equip(static_cast<GearSlot>(index), item);
 }
 
 void Player::unequip(const std::string& slot) {
-    gear_.erase(slot);
+    int index = gearSlotIndex(slot);
+    if (index >= 0) unequip(static_cast<GearSlot>(index));
+}
+
+bool Player::hasItem(const std::string& slot) const {
+    int index = gearSlotIndex(slot);
+    return index >= 0 && gear_[index] != nullptr;
 }
 
 Item Player::getEquippedItem(const std::string& slot) const {
-    auto it = gear_.find(slot);
-    if (it != gear_.end()) {
-        return it->second;
-    }
+    int index = gearSlotIndex(slot);
+    if (index >= 0 && gear_[index]) return *gear_[index];
     return Item();
 }
 
 bool Player::hasEquipped(const std::string& itemName) const {
-    for (const auto& [slot, item] : gear_) {
-        if (item.getName() == itemName) return true;
+    for (int i = 0; i < kGearSlotCount; ++i) {
+        const Item* item = getItem(static_cast<GearSlot>(i));
+        if (item && item->getName() == itemName) return true;
     }
     return false;
 }
 
-int Player::getEffectiveStat(const std::string& stat) {
-    if (stats_.count(stat)) {
-        return stats_.at(stat);
-    }
-    return 1;
+int Player::getEffectiveStat(const std::string& stat) const {
+    int index = skillIndex(stat);
+    return index >= 0 ? levels_[index] : 1;
 }
 
-int Player::getEquipmentBonus(const std::string& bonus) {
+int Player::getEquipmentBonus(const std::string& bonus) const {
+    int stat = itemStatIndex(bonus);
+    if (stat >= 0) return gearBonus_[stat];
+    
     int total = 0;
-    for (auto& [slot, item] : gear_) {
-        total += item.getInt(bonus);
+    for (int i = 0; i < kGearSlotCount; ++i) {
+        if (const Item* item = getItem(static_cast<GearSlot>(i))) total += item->getInt(bonus);
     }
     return total;
 }
 
-int Player::getBoostedLevel(const std::string& skill) {
-    int base = getEffectiveStat(skill);
-    
-    if (superCombat_) {
-        if (skill == "Attack" || skill == "Strength" || skill == "Defence") {
-            return base + 5 + static_cast<int>(base * 0.15);
-        }
-    }
-    
-    return base;
+int Player::getBoostedLevel(const std::string& skill) const {
+    int index = skillIndex(skill);
+    return index >= 0 ? boosted_[index] : 1;
 }
 
-std::string Player::getActiveSet() {
-    bool hasHead = gear_.count("head");
-    bool hasBody = gear_.count("body");
-    bool hasLegs = gear_.count("legs");
-    bool hasHands = gear_.count("hands");
-    
-    if (!hasHead || !hasBody || !hasLegs) return "";
-    
-    std::string head = gear_.at("head").getName();
-    std::string body = gear_.at("body").getName();
-    std::string legs = gear_.at("legs").getName();
-    std::string hands = hasHands ? gear_.at("hands").getName() : "";
-    
-    // Check Void
-    if (hasHands && hands.find("Void knight gloves") != std::string::npos) {
-        bool isEliteTop = body.find("Elite void top") != std::string::npos;
-        bool isEliteLegs = legs.find("Elite void robe") != std::string::npos;
-        bool isVoidTop = body.find("Void knight top") != std::string::npos;
-        bool isVoidLegs = legs.find("Void knight robe") != std::string::npos;
-        
-        if ((isVoidTop || isEliteTop) && (isVoidLegs || isEliteLegs)) {
-            bool isElite = isEliteTop && isEliteLegs;
-            
-            if (head.find("Void melee helm") != std::string::npos) {
-                return isElite ? "Elite Void Melee" : "Void Melee";
-            }
-            if (head.find("Void ranger helm") != std::string::npos) {
-                return isElite ? "Elite Void Range" : "Void Range";
-            }
-            if (head.find("Void mage helm") != std::string::npos) {
-                return isElite ? "Elite Void Mage" : "Void Mage";
-            }
-        }
-    }
-    
-    // Check Crystal
-    if (head.find("Crystal helm") != std::string::npos &&
-        body.find("Crystal body") != std::string::npos &&
-        legs.find("Crystal legs") != std::string::npos) {
-        return "Crystal";
-    }
-    
-    // Check Inquisitor
-    if (head.find("Inquisitor's great helm") != std::string::npos &&
-        body.find("Inquisitor's hauberk") != std::string::npos &&
-        legs.find("Inquisitor's plateskirt") != std::string::npos) {
-        return "Inquisitor";
-    }
-    
-    // Check Obsidian
-    if (head.find("Obsidian helmet") != std::string::npos &&
-        body.find("Obsidian platebody") != std::string::npos &&
-        legs.find("Obsidian platelegs") != std::string::npos) {
-        return "Obsidian";
-    }
-    
-    // Check Dharok
-    bool hasWeapon = gear_.count("weapon");
-    if (hasWeapon) {
-        std::string weapon = gear_.at("weapon").getName();
-        if (head.find("Dharok's helm") != std::string::npos &&
-            body.find("Dharok's platebody") != std::string::npos &&
-            legs.find("Dharok's platelegs") != std::string::npos &&
-            weapon.find("Dharok's greataxe") != std::string::npos) {
-            return "Dharok";
-        }
+Loadout Player::getLoadout() const {
+    Loadout loadout;
+    for (int i = 0; i < kGearSlotCount; ++i) {
+        if (gear_[i]) loadout.set(static_cast<GearSlot>(i), gear_[i]);
     }
-    
-    return "";
+    return loadout;
 }
 
-int Player::countCrystalPieces() {
-    int count = 0;
-    if (gear_.count("head") && gear_.at("head").getName().find("Crystal helm") != std::string::npos) count++;
-    if (gear_.count("body") && gear_.at("body").getName().find("Crystal body") != std::string::npos) count++;
-    if (gear_.count("legs") && gear_.at("legs").getName().find("Crystal legs") != std::string::npos) count++;
-    return count;
+std::string Player::getActiveSet() const {
+    return gearSetName(gearSets_.active());
+}
+
+int Player::countCrystalPieces() const {
+    return gearSets_.pieces(GearSet::Crystal);
 }
 
 #ifndef __EMSCRIPTEN__
@@ -318,7 +365,7 @@ void Player::fetchGearFromClient() {
     } catch(...) {}
 }
 
-void Player::loadGearStats(const json& itemDb) {
+void Player::loadWikiSyncGear(const std::function<void(GearSlot, int)>& equipById) {
     std::ifstream ifs("data/wikisync_data.json");
     if (!ifs.is_open()) {
         std::cerr << "Could not open data/wikisync_data.json. Run fetchGearFromClient first.\n";
@@ -341,12 +388,12 @@ void Player::loadGearStats(const json& itemDb) {
         auto equipment = wsData["payload"]["loadouts"][0]["equipment"];
         
         for (auto& [slot, data] : equipment.items()) {
-            if (data.contains("id")) {
+            int index = gearSlotIndex(slot);
+            if (index >= 0 && data.contains("id")) {
                 int id = data["id"].get<int>();
-                Item item(id);
-                item.fetchStats(id, itemDb);
-                gear_.emplace(slot, item);
-                std::cout << "Loaded " << item.getName() << " (ID: " << id << ") into slot " << slot << "\n";
+                GearSlot gearSlot = static_cast<GearSlot>(index);
+                if (!getItem(gearSlot)) equipById(gearSlot, id);
+                std::cout << "Loaded " << getItem(gearSlot)->getName() << " (ID: " << id << ") into slot " << slot << "\n";
             }
         }
     } else {
@@ -354,6 +401,22 @@ void Player::loadGearStats(const json& itemDb) {
     }
 }
 
+void Player::loadGearStats(const json& itemDb) {
+    loadWikiSyncGear([&](GearSlot slot, int id) {
+        Item item(id);
+        item.fetchStats(id, itemDb);
+        equip(slot, item);
+    });
+}
+
+void Player::loadGearStats(const BinaryDb& db) {
+    loadWikiSyncGear([&](GearSlot slot, int id) {
+        ItemHandle item = db.items().find(id);
+        if (item != kNoItem) equip(slot, db.items(), item);
+        else equip(slot, Item(id));
+    });
+}
+
 void Player::loadGearStats(const std::string& itemDbPath) {
     std::ifstream dbIfs(itemDbPath);
     if (!dbIfs.is_open()) {
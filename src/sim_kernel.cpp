@@ -0,0 +1,107 @@
+// sim_kernel.cpp
+#include "sim_kernel.h"
+#include "sim_lanes.h"
+#include "rng.h"
+
+// Defined in sim_kernel_avx2.cpp, the only file built with AVX2 enabled
+bool avx2KernelCompiled();
+SimStats runFightsAVX2(const SimAttackParams& params, const simlanes::LaneSeeds& seeds, TTKSketch* sketch);
+PairedSimStats runPairedFightsAVX2(const SimAttackParams& params, const simlanes::LaneSeeds& seeds);
+
+namespace {
+
+bool cpuHasAVX2() {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && !defined(__EMSCRIPTEN__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// Each lane gets its own stream and an even share of `work` spread over the
+// first `lanes` lanes; the others mirror them
+simlanes::LaneSeeds makeLaneSeeds(uint64_t seed, int work, int lanes) {
+    simlanes::LaneSeeds seeds;
+    for (int l = 0; l < kSimLanes; ++l) {
+        SplitMix64 sm(streamSeed(seed, static_cast<uint64_t>(l)));
+        uint64_t a = sm.next();
+        uint64_t b = sm.next();
+        seeds.s[0][l] = static_cast<uint32_t>(a);
+        seeds.s[1][l] = static_cast<uint32_t>(a >> 32);
+        seeds.s[2][l] = static_cast<uint32_t>(b);
+        seeds.s[3][l] = static_cast<uint32_t>(b >> 32) | 1u; // Never all-zero
+        int k = l % lanes;
+        seeds.quota[l] = static_cast<uint32_t>(work / lanes + (k < work % lanes ? 1 : 0));
+    }
+    return seeds;
+}
+
+SimBackend resolveBackend(SimBackend backend) {
+    if (backend != SimBackend::Auto && simBackendAvailable(backend)) return backend;
+    if (simBackendAvailable(SimBackend::AVX2)) return SimBackend::AVX2;
+    if (simBackendAvailable(SimBackend::SSE2)) return SimBackend::SSE2;
+    return SimBackend::Scalar;
+}
+
+} // namespace
+
+bool simBackendAvailable(SimBackend backend) {
+    switch (backend) {
+        case SimBackend::Auto:
+        case SimBackend::Scalar:
+            return true;
+        case SimBackend::SSE2:
+#if defined(__SSE2__)
+            return true;
+#else
+            return false;
+#endif
+        case SimBackend::AVX2: {
+            static const bool avx2 = avx2KernelCompiled() && cpuHasAVX2();
+            return avx2;
+        }
+    }
+    return false;
+}
+
+const char* simBackendName(SimBackend backend) {
+    switch (resolveBackend(backend)) {
+        case SimBackend::AVX2: return "avx2";
+        case SimBackend::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+SimStats simulateFightsBatched(const SimAttackParams& params, uint64_t seed, int fights,
+                               SimBackend backend, TTKSketch* sketch) {
+    if (fights <= 0) return {};
+    simlanes::LaneSeeds seeds = makeLaneSeeds(seed, fights, kSimLanes);
+
+    switch (resolveBackend(backend)) {
+        case SimBackend::AVX2:
+            return runFightsAVX2(params, seeds, sketch);
+#if defined(__SSE2__)
+        case SimBackend::SSE2:
+            return simlanes::runFights<simlanes::SSE2Lanes>(params, seeds, sketch);
+#endif
+        default:
+            return simlanes::runFights<simlanes::ScalarLanes>(params, seeds, sketch);
+    }
+}
+
+PairedSimStats simulatePairsBatched(const SimAttackParams& params, uint64_t seed, int pairs,
+                                    SimBackend backend) {
+    if (pairs <= 0) return {};
+    simlanes::LaneSeeds seeds = makeLaneSeeds(seed, pairs, kSimLanes / 2);
+
+    switch (resolveBackend(backend)) {
+        case SimBackend::AVX2:
+            return runPairedFightsAVX2(params, seeds);
+#if defined(__SSE2__)
+        case SimBackend::SSE2:
+            return simlanes::runPairedFights<simlanes::SSE2Lanes>(params, seeds);
+#endif
+        default:
+            return simlanes::runPairedFights<simlanes::ScalarLanes>(params, seeds);
+    }
+}
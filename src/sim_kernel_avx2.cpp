@@ -0,0 +1,30 @@
+// sim_kernel_avx2.cpp
+// Built with -mavx2 on x86; compiles to a stub everywhere else.
+#include "sim_kernel.h"
+#include "sim_lanes.h"
+
+#if defined(__AVX2__)
+
+bool avx2KernelCompiled() { return true; }
+
+SimStats runFightsAVX2(const SimAttackParams& params, const simlanes::LaneSeeds& seeds, TTKSketch* sketch) {
+    return simlanes::runFights<simlanes::AVX2Lanes>(params, seeds, sketch);
+}
+
+PairedSimStats runPairedFightsAVX2(const SimAttackParams& params, const simlanes::LaneSeeds& seeds) {
+    return simlanes::runPairedFights<simlanes::AVX2Lanes>(params, seeds);
+}
+
+#else
+
+bool avx2KernelCompiled() { return false; }
+
+SimStats runFightsAVX2(const SimAttackParams&, const simlanes::LaneSeeds&, TTKSketch*) {
+    return {}; // Never selected: simBackendAvailable(AVX2) is false
+}
+
+PairedSimStats runPairedFightsAVX2(const SimAttackParams&, const simlanes::LaneSeeds&) {
+    return {};
+}
+
+#endif
@@ -0,0 +1,71 @@
+// ttk_sketch.cpp
+#include "ttk_sketch.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kGamma = 1.02;
+}
+
+int TTKSketch::logBin(uint32_t attacks) {
+    static const double invLogGamma = 1.0 / std::log(kGamma);
+    int k = static_cast<int>(std::log(attacks / static_cast<double>(kExactAttacks)) * invLogGamma);
+    return std::min(kExactAttacks + k, kBins - 1);
+}
+
+double TTKSketch::binValue(int bin) {
+    if (bin < kExactAttacks) return bin;
+    double lower = kExactAttacks * std::pow(kGamma, bin - kExactAttacks);
+    return lower * (1.0 + kGamma) / 2.0;
+}
+
+void TTKSketch::add(uint32_t attacks) {
+    ++counts_[attacks < kExactAttacks ? attacks : logBin(attacks)];
+    ++fights_;
+    if (attacks < min_) min_ = attacks;
+    if (attacks > max_) max_ = attacks;
+}
+
+void TTKSketch::add(const uint32_t* attacks, int count) {
+    for (int i = 0; i < count; ++i) add(attacks[i]);
+}
+
+void TTKSketch::merge(const TTKSketch& other) {
+    for (int i = 0; i < kBins; ++i) counts_[i] += other.counts_[i];
+    fights_ += other.fights_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+double TTKSketch::quantileAttacks(double q) const {
+    if (fights_ == 0) return 0.0;
+    double rank = std::max(1.0, std::ceil(q * static_cast<double>(fights_)));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBins; ++i) {
+        seen += counts_[i];
+        if (seen >= rank) return std::min(binValue(i), static_cast<double>(max_));
+    }
+    return max_;
+}
+
+TTKHistogram TTKSketch::histogram(int attackSpeed, int maxBuckets) const {
+    TTKHistogram hist;
+    if (fights_ == 0 || maxBuckets <= 0) return hist;
+
+    uint32_t lo = min_;
+    uint32_t hi = std::max(lo, static_cast<uint32_t>(quantileAttacks(0.999)));
+    uint32_t span = hi - lo + 1;
+    uint32_t width = (span + maxBuckets - 1) / maxBuckets;
+    int buckets = static_cast<int>((span + width - 1) / width);
+
+    hist.startTicks = static_cast<int>(lo) * attackSpeed;
+    hist.bucketTicks = static_cast<int>(width) * attackSpeed;
+    hist.counts.assign(buckets, 0);
+    for (int i = 0; i < kBins; ++i) {
+        if (counts_[i] == 0) continue;
+        double v = std::max(binValue(i), static_cast<double>(lo));
+        int b = std::min(static_cast<int>((v - lo) / width), buckets - 1);
+        hist.counts[b] += counts_[i];
+    }
+    return hist;
+}
@@ -1,5 +1,5 @@
 #include "upgrade_advisor.h"
-#include "battle.h"
+#include "battle_profile.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
@@ -8,14 +8,15 @@
 
 // Helper struct for internal use
 struct Candidate {
-    Item item;
+    const Item* item;   // Owned by an ItemArena, so candidates copy cheaply
     int price;
     std::string slot; // normalized slot ("weapon", "head", etc)
     std::string rawSlot; // "2h", "body", etc
+    GearSlot gearSlot;
 };
 
-UpgradeAdvisor::UpgradeAdvisor(Player& p, Monster& m, const json& items, const json& prices)
-    : player_(p), monster_(m), itemDb_(items), priceDb_(prices) {
+UpgradeAdvisor::UpgradeAdvisor(Player& p, Monster& m)
+    : player_(p), monster_(m) {
     
     // Manual Price Proxies for Untradeables
     // Item ID -> Tradeable Component ID (for price)
@@ -26,12 +27,50 @@ UpgradeAdvisor::UpgradeAdvisor(Player& p, Monster& m, const json& items, const j
     fixedPriceProxies_[12018] = 1; // Salve amulet(ei)
 }
 
+UpgradeAdvisor::UpgradeAdvisor(Player& p, Monster& m, const json& items, const json& prices)
+    : UpgradeAdvisor(p, m) {
+    itemDb_ = &items;
+    priceDb_ = &prices;
+}
+
+UpgradeAdvisor::UpgradeAdvisor(Player& p, Monster& m, const BinaryDb& db)
+    : UpgradeAdvisor(p, m) {
+    db_ = &db;
+}
+
+int UpgradeAdvisor::marketPrice(int id) const {
+    // 1. Check Fixed Price Proxy
+    auto fixed = fixedPriceProxies_.find(id);
+    if (fixed != fixedPriceProxies_.end()) return fixed->second;
+
+    // 2. Check Item/Component Price
+    auto proxy = priceProxies_.find(id);
+    int priceId = (proxy != priceProxies_.end()) ? proxy->second : id;
+
+    int high = 0;
+    int low = 0;
+    if (db_) {
+        const binarydb::PriceRecord* record = db_->findPrice(priceId);
+        if (!record) return 0;
+        high = record->high;
+        low = record->low;
+    } else {
+        const json& data = (*priceDb_)["data"];
+        std::string idKey = std::to_string(priceId);
+        if (!data.contains(idKey)) return 0;
+        high = data[idKey].value("high", 0);
+        low = data[idKey].value("low", 0);
+    }
+    if (high > 0 && low > 0) return (high + low) / 2;
+    return (high > 0) ? high : low;
+}
+
 bool UpgradeAdvisor::isPotentialUpgrade(const Item& candidate, const Item& current) {
     // Check key offensive stats
-    std::vector<std::string> offensiveStats = {
-        "strength_bonus", "melee_strength", 
-        "attack_stab", "attack_slash", "attack_crush",
-        "ranged_strength", "magic_damage"
+    static const ItemStat offensiveStats[] = {
+        ItemStat::StrengthBonus, ItemStat::MeleeStrength,
+        ItemStat::AttackStab, ItemStat::AttackSlash, ItemStat::AttackCrush,
+        ItemStat::RangedStrength, ItemStat::MagicDamage
     };
 
     // If current item is just a placeholder (ID -1 or 0 stats), almost anything is an upgrade
@@ -41,22 +80,14 @@ bool UpgradeAdvisor::isPotentialUpgrade(const Item& candidate, const Item& curre
     // AND that stat should be relevant (e.g. > 0)
     
     // Exception: Items with Special Effects that don't show in stats
-    std::string name = candidate.getName();
-    if (name.find("Dragon hunter lance") != std::string::npos ||
-        name.find("Osmumten's fang") != std::string::npos || 
-        name.find("Scythe of vitur") != std::string::npos ||
-        name.find("Twisted bow") != std::string::npos || 
-        name.find("Dragon hunter crossbow") != std::string::npos ||
-        name.find("Salve amulet") != std::string::npos) {
-        return true;
-    }
+    constexpr ItemEffects specialEffects =
+        effectBit(ItemEffect::DragonHunterLance) | effectBit(ItemEffect::OsmumtensFang) |
+        effectBit(ItemEffect::ScytheOfVitur) | effectBit(ItemEffect::TwistedBow) |
+        effectBit(ItemEffect::DragonHunterCrossbow) | effectBit(ItemEffect::Salve);
+    if (candidate.getEffects() & specialEffects) return true;
 
-    for (const auto& stat : offensiveStats) {
-        // We use const_cast because getInt is not const in Item (should be fixed later)
-        int candVal = const_cast<Item&>(candidate).getInt(stat);
-        int currVal = const_cast<Item&>(current).getInt(stat);
-        
-        if (candVal > currVal) return true;
+    for (ItemStat stat : offensiveStats) {
+        if (candidate.getStat(stat) > current.getStat(stat)) return true;
     }
     
     return false;
@@ -66,8 +97,7 @@ std::vector<UpgradeSuggestion> UpgradeAdvisor::suggestUpgrades() {
     std::vector<UpgradeSuggestion> suggestions;
     
     // 1. Baseline DPS
-    Battle baselineBattle(player_, monster_);
-    double currentDps = baselineBattle.solveOptimalDPS();
+    double currentDps = BattleProfile::compile(player_, monster_).optimalDPS();
     
     std::cout << "Calculating upgrades... (Current DPS: " << currentDps << ")\n";
 
@@ -79,31 +109,30 @@ std::vector<UpgradeSuggestion> UpgradeAdvisor::suggestUpgrades() {
 
     // 2. Iterate all items to gather candidates
     int processed = 0;
-    int total = itemDb_.size();
+    int total = db_ ? static_cast<int>(db_->itemCount()) : static_cast<int>(itemDb_->size());
     int potentialCandidates = 0;
 
-    for (auto& [idStr, itemData] : itemDb_.items()) {
+    // Items built from the JSON live here until the scan is done; the
+    // compiled database already holds its items
+    ItemArena jsonItems;
+
+    // findItem yields the candidate once the cheap filters pass
+    auto consider = [&](int id, bool isTradeable, bool isEquipable, auto findItem) {
         processed++;
         if (processed % 1000 == 0) std::cout << "\rScanning items: " << processed << "/" << total << std::flush;
 
-        // Basic filters
-        bool isTradeable = itemData.value("tradeable_on_ge", false);
-        int id = std::stoi(idStr);
-        
         // Special check for price proxies (allow if in proxy list)
         bool hasProxy = (priceProxies_.find(id) != priceProxies_.end());
         bool hasFixedProxy = (fixedPriceProxies_.find(id) != fixedPriceProxies_.end());
         
-        if (!isTradeable && !hasProxy && !hasFixedProxy) continue;
-        if (!itemData.value("equipable_by_player", false)) continue;
+        if (!isTradeable && !hasProxy && !hasFixedProxy) return;
+        if (!isEquipable) return;
         
-        // Create Item object
-        Item candidate(id);
-        candidate.fetchStats(id, itemDb_);
+        const Item& candidate = findItem();
         
         // Check slot
-        std::string rawSlot = candidate.getStr("slot");
-        if (rawSlot.empty()) continue; 
+        const std::string& rawSlot = candidate.getSlot();
+        if (rawSlot.empty()) return; 
         
         // Logic for 2H weapons:
         // - rawSlot "2h" maps to gear slot "weapon"
@@ -113,72 +142,60 @@ std::vector<UpgradeSuggestion> UpgradeAdvisor::suggestUpgrades() {
         std::string targetSlot = rawSlot;
         if (targetSlot == "2h") targetSlot = "weapon";
         
+        int slotIndex = gearSlotIndex(targetSlot);
+        if (slotIndex < 0) return;
+        
         // Get current item in this slot
-        Item currentItem("Empty");
-        auto currentGear = player_.getGear();
-        if (currentGear.count(targetSlot)) {
-            currentItem = currentGear.at(targetSlot);
-        }
+        static const Item emptyItem("Empty");
+        const Item* equipped = player_.getItem(static_cast<GearSlot>(slotIndex));
+        const Item& currentItem = equipped ? *equipped : emptyItem;
         
         // Skip if same item
-        if (candidate.getID() == currentItem.getID()) continue;
+        if (candidate.getID() == currentItem.getID()) return;
+
+        // Ammo the current weapon takes no stats from cannot raise DPS
+        if (slotIndex == static_cast<int>(GearSlot::Ammo)) {
+            const Item* weapon = player_.getItem(GearSlot::Weapon);
+            if (!weapon || !ammoCompatible(weapon->getWeaponClass(), candidate.getAmmoClass())) return;
+        }
 
         // Optimization: Pre-filter based on stats before running simulation
-        if (!isPotentialUpgrade(candidate, currentItem)) continue;
+        if (!isPotentialUpgrade(candidate, currentItem)) return;
 
-        // Get Price
-        int price = 0;
-        
-        // 1. Check Fixed Price Proxy
-        if (fixedPriceProxies_.count(id)) {
-            price = fixedPriceProxies_.at(id);
-        } else {
-            // 2. Check Item/Component Price
-            int priceId = id;
-            if (priceProxies_.count(id)) {
-                priceId = priceProxies_.at(id);
-            }
-            
-            std::string idKey = std::to_string(priceId);
-            if (priceDb_["data"].contains(idKey)) {
-                 int high = priceDb_["data"][idKey].value("high", 0);
-                 int low = priceDb_["data"][idKey].value("low", 0);
-                 if (high > 0 && low > 0) price = (high + low) / 2;
-                 else if (high > 0) price = high;
-                 else price = low;
-            }
-        }
-        
-        if (price <= 0) continue;
+        int price = marketPrice(id);
+        if (price <= 0) return;
 
-        candidatesBySlot[targetSlot].push_back({candidate, price, targetSlot, rawSlot});
+        candidatesBySlot[targetSlot].push_back({&candidate, price, targetSlot, rawSlot, static_cast<GearSlot>(slotIndex)});
         potentialCandidates++;
+    };
+
+    if (db_) {
+        // Flags are read from the records; items() already holds each Item
+        for (size_t i = 0; i < db_->itemCount(); ++i) {
+            const binarydb::ItemRecord& record = db_->itemAt(i);
+            consider(record.id, record.flags & binarydb::kItemTradeable, record.flags & binarydb::kItemEquipable,
+                     [&]() -> const Item& { return db_->items().get(static_cast<ItemHandle>(i + 1)); });
+        }
+    } else {
+        for (auto& [idStr, itemData] : itemDb_->items()) {
+            int id = std::stoi(idStr);
+            consider(id, itemData.value("tradeable_on_ge", false), itemData.value("equipable_by_player", false), [&]() -> const Item& {
+                Item candidate(id);
+                candidate.fetchStats(id, *itemDb_);
+                return jsonItems.get(jsonItems.add(std::move(candidate)));
+            });
+        }
     }
     std::cout << "\rScanning items: Done! Candidates found: " << potentialCandidates << "       \n";
 
-    // Helper lambda to simulate a set of items
-    auto simulate = [&](const std::vector<Candidate>& items) -> double {
-        Player pClone = player_;
-        
-        for (const auto& c : items) {
-             if (c.rawSlot == "2h") {
-                pClone.unequip("shield");
-                pClone.equip("weapon", c.item);
-            } else if (c.slot == "shield") {
-                if (pClone.getGear().count("weapon")) {
-                    Item w = pClone.getGear().at("weapon");
-                    if (w.getStr("slot") == "2h") {
-                        pClone.unequip("weapon");
-                    }
-                }
-                pClone.equip("shield", c.item);
-            } else {
-                pClone.equip(c.slot, c.item);
-            }
-        }
-        
-        Battle simBattle(pClone, monster_);
-        return simBattle.solveOptimalDPS();
+    // Helper lambda to evaluate the player wearing a set of items. Candidates
+    // are worn on a copy of the current gear view, so neither the Player nor
+    // its items are copied.
+    const Loadout baseLoadout = player_.getLoadout();
+    auto simulate = [&](std::initializer_list<const Candidate*> items) -> double {
+        Loadout loadout = baseLoadout;
+        for (const Candidate* c : items) loadout.wear(c->gearSlot, c->item);
+        return BattleProfile::compile(player_, loadout, monster_).optimalDPS();
     };
 
     // 3. Phase 2: Single Item Analysis & Filtering
@@ -191,7 +208,7 @@ std::vector<UpgradeSuggestion> UpgradeAdvisor::suggestUpgrades() {
     for (const auto& [slot, candidates] : candidatesBySlot) {
         for (const auto& cand : candidates) {
             
-            double newDps = simulate({cand});
+            double newDps = simulate({&cand});
             
              // Threshold for "significant" increase to avoid floating point noise with useless items
              // Also filters out items that don't increase DPS at all (like ammo when meleeing)
@@ -199,15 +216,15 @@ std::vector<UpgradeSuggestion> UpgradeAdvisor::suggestUpgrades() {
                 double increase = newDps - currentDps;
                 double efficiency = (increase / cand.price) * 1000000.0; // DPS increase per 1M GP
                 
-                singleUpgradeDps[cand.item.getID()] = newDps;
+                singleUpgradeDps[cand.item->getID()] = newDps;
 
                 // Add to useful candidates for Duo check
                 usefulCandidatesBySlot[slot].push_back(cand);
                 usefulCount++;
 
                 suggestions.push_back({
-                    {cand.item.getName()},
-                    {cand.item.getID()},
+                    {cand.item->getName()},
+                    {cand.item->getID()},
                     {cand.rawSlot},
                     cand.price,
                     currentDps,
@@ -244,7 +261,7 @@ std::vector<UpgradeSuggestion> UpgradeAdvisor::suggestUpgrades() {
                     if (cB.rawSlot == "2h" && cA.slot == "shield") continue;
                     
                     // Run Sim
-                    double newDps = simulate({cA, cB});
+                    double newDps = simulate({&cA, &cB});
                     
                     // Filter: Duo DPS must be > current DPS
                     if (newDps > currentDps + 0.001) {
@@ -254,8 +271,8 @@ std::vector<UpgradeSuggestion> UpgradeAdvisor::suggestUpgrades() {
                         // If Duo(A, B) == Single(A), then B is useless. Discard duo.
                         // If Duo(A, B) == Single(B), then A is useless. Discard duo.
                         
-                        double dpsA = (singleUpgradeDps.count(cA.item.getID())) ? singleUpgradeDps[cA.item.getID()] : currentDps;
-                        double dpsB = (singleUpgradeDps.count(cB.item.getID())) ? singleUpgradeDps[cB.item.getID()] : currentDps;
+                        double dpsA = (singleUpgradeDps.count(cA.item->getID())) ? singleUpgradeDps[cA.item->getID()] : currentDps;
+                        double dpsB = (singleUpgradeDps.count(cB.item->getID())) ? singleUpgradeDps[cB.item->getID()] : currentDps;
                         
                         // Allow small floating point epsilon
                         double maxSingle = std::max(dpsA, dpsB);
@@ -266,8 +283,8 @@ std::vector<UpgradeSuggestion> UpgradeAdvisor::suggestUpgrades() {
                             double efficiency = (increase / totalPrice) * 1000000.0;
                             
                             suggestions.push_back({
-                                {cA.item.getName(), cB.item.getName()},
-                                {cA.item.getID(), cB.item.getID()},
+                                {cA.item->getName(), cB.item->getName()},
+                                {cA.item->getID(), cB.item->getID()},
                                 {cA.rawSlot, cB.rawSlot},
                                 totalPrice,
                                 currentDps,
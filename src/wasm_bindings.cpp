@@ -9,6 +9,7 @@
 #include "item.h"
 #include "battle.h"
 #include "upgrade_advisor.h"
+#include "fingerprint.h"
 
 using namespace emscripten;
 
@@ -27,6 +28,7 @@ public:
             player_ = player;
             monster_ = monster;
             itemDb_ = json::parse(itemDbJson);
+            ItemEffectRegistry::instance().indexItemDb(itemDb_);
             priceDb_ = json::parse(priceDbJson);
         } catch (const std::exception& e) {
             std::cerr << "Error initializing UpgradeAdvisor: " << e.what() << "\n";
@@ -108,6 +110,7 @@ void loadMonsterFromJson(Monster& monster, const std::string& name, const std::s
                 } else if (value.is_boolean()) {
                     monster.setBool(key, value.get<bool>());
                 } else if (key == "attributes" && value.is_array()) {
+                    monster.clearAttributes();
                     for (const auto& attr : value) {
                         if (attr.is_string()) {
                             monster.addAttribute(attr.get<std::string>());
@@ -144,6 +147,29 @@ void loadMonsterFromJson(Monster& monster, const std::string& name, const std::s
     }
 }
 
+// Stance rows as a JSON array
+json stancesToJson(const StanceDPS* rows, int count) {
+    json arr = json::array();
+    for (int i = 0; i < count; ++i) {
+        const StanceDPS& row = rows[i];
+        arr.push_back({
+            {"style", combatStyleName(row.option.style)},
+            {"stance", row.option.name},
+            {"attackSpeed", row.attackSpeed},
+            {"maxHit", row.maxHit},
+            {"hitChance", row.hitChance},
+            {"dps", row.dps}
+        });
+    }
+    return arr;
+}
+
+// Get every stance of the battle's style family as JSON string
+std::string getStanceTableJson(Battle& battle) {
+    StanceTable table = battle.getStanceTable();
+    return stancesToJson(table.rows, table.count).dump();
+}
+
 // Get battle results as JSON string
 std::string getBattleResultsJson(Battle& battle) {
     BattleResult result = battle.getResults();
@@ -156,6 +182,11 @@ std::string getBattleResultsJson(Battle& battle) {
         {"stance", result.stance},
         {"attackSpeed", result.attackSpeed},
         {"avgTTK", result.avgTTK},
+        {"ttkStdDev", result.ttkStdDev},
+        {"ttkP50", result.ttkP50},
+        {"ttkP90", result.ttkP90},
+        {"ttkP99", result.ttkP99},
+        {"ttkPercentilesExact", result.ttkPercentilesExact},
         {"killsPerHour", result.killsPerHour},
         {"isFang", result.isFang},
         {"isDHL", result.isDHL},
@@ -166,12 +197,50 @@ std::string getBattleResultsJson(Battle& battle) {
         {"isTbow", result.isTbow},
         {"hasSalve", result.hasSalve},
         {"onTask", result.onTask},
-        {"activeSet", result.activeSet}
+        {"activeSet", result.activeSet},
+        {"stances", stancesToJson(result.stances.data(), static_cast<int>(result.stances.size()))},
+        {"simTTKP50", result.simTTKP50},
+        {"simTTKP90", result.simTTKP90},
+        {"simTTKP99", result.simTTKP99},
+        {"ttkHistogram", {
+            {"startTicks", result.ttkHistogram.startTicks},
+            {"bucketTicks", result.ttkHistogram.bucketTicks},
+            {"counts", result.ttkHistogram.counts}
+        }}
     };
     
     return j.dump();
 }
 
+// JavaScript numbers hold integers up to 2^53 exactly, plenty for a seed
+void setBattleSeed(Battle& battle, double seed) {
+    battle.setSeed(static_cast<uint64_t>(seed));
+}
+
+// Manifest of the battle's last runSimulations call as JSON string
+std::string getLastRunJson(Battle& battle) {
+    return battle.getLastRun().toJson();
+}
+
+// Replays a manifest produced by getLastRunJson
+bool replayRunJson(Battle& battle, const std::string& manifestJson) {
+    RunManifest manifest;
+    return RunManifest::fromJson(manifestJson, manifest) && battle.replay(manifest, 1);
+}
+
+// Fingerprints as 16 hex digits; equal strings mean equal combat states
+std::string getPlayerFingerprint(const Player& player) {
+    return fingerprintHex(player.fingerprint());
+}
+
+std::string getMonsterFingerprint(const Monster& monster) {
+    return fingerprintHex(monster.fingerprint());
+}
+
+std::string getStateFingerprint(const Player& player, const Monster& monster) {
+    return fingerprintHex(stateFingerprint(player, monster));
+}
+
 // Helper factory functions for Item constructors
 Item createItemFromString(const std::string& name) {
     return Item(name);
@@ -182,6 +251,25 @@ Item createItemFromInt(int id) {
 }
 
 EMSCRIPTEN_BINDINGS(osrs_calc) {
+    value_object<TTKDistribution>("TTKDistribution")
+        .field("expectedTicks", &TTKDistribution::expectedTicks)
+        .field("expectedSeconds", &TTKDistribution::expectedSeconds)
+        .field("varianceTicks", &TTKDistribution::varianceTicks)
+        .field("expectedAttacks", &TTKDistribution::expectedAttacks)
+        .field("p50Ticks", &TTKDistribution::p50Ticks)
+        .field("p90Ticks", &TTKDistribution::p90Ticks)
+        .field("p99Ticks", &TTKDistribution::p99Ticks)
+        .field("killable", &TTKDistribution::killable)
+        .field("percentilesExact", &TTKDistribution::percentilesExact);
+    
+    value_object<SimulationEstimate>("SimulationEstimate")
+        .field("meanTicks", &SimulationEstimate::meanTicks)
+        .field("stdErrorTicks", &SimulationEstimate::stdErrorTicks)
+        .field("ciHalfWidthTicks", &SimulationEstimate::ciHalfWidthTicks)
+        .field("fights", &SimulationEstimate::fights)
+        .field("converged", &SimulationEstimate::converged)
+        .field("varianceReduction", &SimulationEstimate::varianceReduction);
+    
     // Item class
     class_<Item>("Item")
         .constructor<>()
@@ -205,16 +293,16 @@ EMSCRIPTEN_BINDINGS(osrs_calc) {
         .constructor<std::string>()
         .function("getUsername", &Player::getUsername)
         .function("setUsername", &Player::setUsername)
-        .function("getStat", &Player::getStat)
-        .function("setStat", &Player::setStat)
+        .function("getStat", select_overload<int(const std::string&) const>(&Player::getStat))
+        .function("setStat", select_overload<void(const std::string&, int)>(&Player::setStat))
         .function("parseStats", &Player::parseStats)
-        .function("equip", &Player::equip)
-        .function("unequip", &Player::unequip)
+        .function("equip", select_overload<void(const std::string&, const Item&)>(&Player::equip))
+        .function("unequip", select_overload<void(const std::string&)>(&Player::unequip))
         .function("clearGear", &Player::clearGear)
         .function("hasItem", &Player::hasItem)
         .function("getEquippedItem", &Player::getEquippedItem)
         .function("getEffectiveStat", &Player::getEffectiveStat)
-        .function("getEquipmentBonus", &Player::getEquipmentBonus)
+        .function("getEquipmentBonus", select_overload<int(const std::string&) const>(&Player::getEquipmentBonus))
         .function("setSlayerTask", &Player::setSlayerTask)
         .function("isOnSlayerTask", &Player::isOnSlayerTask)
         .function("setHP", &Player::setHP)
@@ -228,6 +316,13 @@ EMSCRIPTEN_BINDINGS(osrs_calc) {
         .function("setSuperCombat", &Player::setSuperCombat)
         .function("isSuperCombatActive", &Player::isSuperCombatActive);
     
+    // Returned by Monster.getVampyreTier
+    enum_<VampyreTier>("VampyreTier")
+        .value("None", VampyreTier::None)
+        .value("Tier1", VampyreTier::Tier1)
+        .value("Tier2", VampyreTier::Tier2)
+        .value("Tier3", VampyreTier::Tier3);
+    
     // Monster class
     class_<Monster>("Monster")
         .constructor<>()
@@ -241,7 +336,9 @@ EMSCRIPTEN_BINDINGS(osrs_calc) {
         .function("setStr", &Monster::setStr)
         .function("setBool", &Monster::setBool)
         .function("addAttribute", &Monster::addAttribute)
-        .function("hasAttribute", &Monster::hasAttribute)
+        .function("clearAttributes", &Monster::clearAttributes)
+        .function("hasAttribute", select_overload<bool(const std::string&) const>(&Monster::hasAttribute))
+        .function("getVampyreTier", &Monster::getVampyreTier)
         .function("getCurrentHP", &Monster::getCurrentHP)
         .function("setCurrentHP", &Monster::setCurrentHP)
         .function("resetHP", &Monster::resetHP)
@@ -260,8 +357,10 @@ EMSCRIPTEN_BINDINGS(osrs_calc) {
     // Battle class
     class_<Battle>("Battle")
         .constructor<Player&, Monster&>()
-        .function("simulate", &Battle::simulate)
-        .function("runSimulations", &Battle::runSimulations)
+        .function("simulate", select_overload<int()>(&Battle::simulate))
+        .function("runSimulations", select_overload<double(int)>(&Battle::runSimulations))
+        .function("runSimulationsAdaptive", select_overload<SimulationEstimate(double, int)>(&Battle::runSimulationsAdaptive))
+        .function("solveTTK", &Battle::solveTTK)
         .function("optimizeAttackStyle", &Battle::optimizeAttackStyle)
         .function("solveOptimalDPS", &Battle::solveOptimalDPS)
         .function("getStyle", &Battle::getStyle)
@@ -283,7 +382,14 @@ EMSCRIPTEN_BINDINGS(osrs_calc) {
     // Helper functions
     function("loadItemFromJson", &loadItemFromJson);
     function("loadMonsterFromJson", &loadMonsterFromJson);
+    function("getStanceTableJson", &getStanceTableJson);
     function("getBattleResultsJson", &getBattleResultsJson);
+    function("setBattleSeed", &setBattleSeed);
+    function("getLastRunJson", &getLastRunJson);
+    function("replayRunJson", &replayRunJson);
+    function("getPlayerFingerprint", &getPlayerFingerprint);
+    function("getMonsterFingerprint", &getMonsterFingerprint);
+    function("getStateFingerprint", &getStateFingerprint);
 }
 
 #endif // __EMSCRIPTEN__
@@ -0,0 +1,139 @@
+// test/test_binary_db.cpp
+#include "../item.h"
+#include "../item_effects.h"
+#include "../monster.h"
+#include "../binary_db.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+void testBinaryDb() {
+    std::cout << "Testing binary database round trip...\n";
+    json items = json::parse(R"json({
+        "4151": {"name": "Abyssal whip", "tradeable_on_ge": true, "equipable_by_player": true,
+                 "equipment": {"attack_slash": 82, "melee_strength": 82, "slot": "weapon"},
+                 "weapon": {"attack_speed": 4, "weapon_type": "whip"}},
+        "861": {"name": "Magic shortbow", "tradeable_on_ge": true, "equipable_by_player": true,
+                "equipment": {"attack_ranged": 69, "slot": "2h"},
+                "weapon": {"attack_speed": 4, "weapon_type": "bow"}},
+        "995": {"name": "Coins", "tradeable_on_ge": false}
+    })json");
+    json prices = json::parse(R"json({"data": {"4151": {"high": 1500000, "low": 1400000}, "861": {"high": 900, "low": null}}})json");
+    json nodrops = json::parse(R"json({
+        "1": {"name": "Vorkath (Post-quest)", "hitpoints": 750, "defence_level": 214, "defence_stab": 26,
+              "attributes": ["dragon", "undead"]}
+    })json");
+    json bosses = json::parse(R"json([
+        {"name": "Vyrewatch Sentinel", "hitpoints": null},
+        {"name": "Vyrewatch Sentinel (level 149)", "hitpoints": 110, "size": 1, "attributes": ["vampyre2"]}
+    ])json");
+
+    std::string contents = binarydb::compile(items, prices, {nodrops, bosses});
+    BinaryDb db;
+    assert(db.load(contents));
+    assert(db.itemCount() == 2 && db.monsterCount() == 3 && db.priceCount() == 2);
+
+    // Items come back as fetchStats builds them from the JSON
+    const binarydb::ItemRecord* record = db.findItem(4151);
+    assert(record && (record->flags & binarydb::kItemTradeable));
+    Item fromJson(4151);
+    fromJson.fetchStats(4151, items);
+    Item fromDb = db.makeItem(*record);
+    assert(fromDb == fromJson && fromDb.getEffects() == fromJson.getEffects());
+    assert(db.makeItem(*db.findItem(861)).getWeaponClass() == WeaponClass::Bow);
+    assert(!db.findItem(995) && !db.findItem(1));
+
+    assert(db.findPrice(4151)->low == 1400000 && db.findPrice(861)->low == 0 && !db.findPrice(995));
+
+    // Object files match exactly; array files by prefix with hitpoints
+    Monster vorkath("Vorkath (Post-quest)");
+    assert(db.loadMonster("Vorkath (Post-quest)", vorkath));
+    assert(vorkath.getCurrentHP() == 750 && vorkath.isDragon() && vorkath.isUndead());
+    assert(vorkath.combat().defenceRoll[0] == (214 + 9) * (26 + 64));
+    Monster vorkathPrefix("Vorkath");
+    assert(!db.loadMonster("Vorkath", vorkathPrefix));
+    Monster vyre("Vyrewatch Sentinel");
+    assert(db.loadMonster("Vyrewatch Sentinel", vyre));
+    assert(vyre.getInt("hitpoints") == 110 && vyre.getVampyreTier() == VampyreTier::Tier2);
+
+    // Items take the stored traits rather than matching their name again
+    binarydb::Header header;
+    std::memcpy(&header, contents.data(), sizeof(header));
+    std::string patched = contents;
+    auto* first = reinterpret_cast<binarydb::ItemRecord*>(&patched[header.itemsOffset]);
+    assert(first->id == 861 && first->weaponClass == static_cast<uint8_t>(WeaponClass::Bow));
+    first->effects = effectBit(ItemEffect::TwistedBow);
+    BinaryDb patchedDb;
+    assert(patchedDb.load(patched));
+    assert(patchedDb.makeItem(*patchedDb.findItem(861)).hasEffect(ItemEffect::TwistedBow));
+
+    // Files from another format version are refused
+    std::string stale = contents;
+    stale[8] = static_cast<char>(binarydb::kVersion + 1);
+    assert(!db.load(stale) && !db.isOpen());
+    assert(!db.load(contents.substr(0, contents.size() / 2)));
+
+    // The mapped file reads the same records
+    const char* path = "test_binary_db.tmp";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+    assert(db.open(path));
+    assert(db.makeItem(*db.findItem(4151)) == fromJson && db.findPrice(861)->high == 900);
+    std::remove(path);
+    std::cout << "PASS\n";
+}
+
+// Writes a JSON file for loadFromJSON
+void writeJson(const char* path, const json& data) {
+    std::ofstream out(path);
+    out << data.dump();
+}
+
+void testMonsterSources() {
+    std::cout << "Testing binary database monsters against the JSON files...\n";
+    // Zulrah has no hitpoints in the first file, so the JSON path falls
+    // back to the bosses file; Vorkath is complete in both
+    json nodrops = json::parse(R"json({
+        "1": {"name": "Zulrah", "combat_level": 725, "defence_level": 300, "attributes": []},
+        "2": {"name": "Vorkath (Post-quest)", "hitpoints": 750, "defence_level": 214, "attributes": ["dragon"]}
+    })json");
+    json bosses = json::parse(R"json([
+        {"name": "Zulrah (Serpentine)", "hitpoints": 500, "defence_level": 300, "defence_magic": -45, "size": 5},
+        {"name": "Vorkath (Post-quest)", "hitpoints": 1, "defence_level": 1}
+    ])json");
+    const char* nodropsPath = "test_binary_db_nodrops.tmp";
+    const char* bossesPath = "test_binary_db_bosses.tmp";
+    writeJson(nodropsPath, nodrops);
+    writeJson(bossesPath, bosses);
+
+    BinaryDb db;
+    assert(db.load(binarydb::compile(json::object(), json::object(), {nodrops, bosses})));
+    for (const char* name : {"Zulrah", "Vorkath (Post-quest)"}) {
+        Monster fromJson(name);
+        fromJson.loadFromJSON(nodropsPath);
+        if (fromJson.getCurrentHP() == 0) fromJson.loadFromJSON(bossesPath);
+        Monster fromDb(name);
+        assert(db.loadMonster(name, fromDb));
+        assert(fromDb.getCurrentHP() == fromJson.getCurrentHP() && fromDb.getCurrentHP() > 0);
+        assert(fromDb.fingerprint() == fromJson.fingerprint());
+    }
+    Monster zulrah("Zulrah");
+    db.loadMonster("Zulrah", zulrah);
+    assert(zulrah.getCurrentHP() == 500 && zulrah.getInt("combat_level") == 725);
+
+    std::remove(nodropsPath);
+    std::remove(bossesPath);
+    std::cout << "PASS\n";
+}
+
+int main() {
+    testBinaryDb();
+    testMonsterSources();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,153 @@
+// test/test_items.cpp
+#include "../item.h"
+#include "../item_arena.h"
+#include "../item_effects.h"
+#include "../player.h"
+#include "../monster.h"
+#include "../battle_profile.h"
+#include <iostream>
+#include <cassert>
+
+Item makeWhip() {
+    Item whip("Abyssal whip");
+    whip.setInt("attack_slash", 82);
+    whip.setInt("strength_bonus", 82);
+    whip.setInt("attack_speed", 4);
+    return whip;
+}
+
+void testItemStats() {
+    std::cout << "Testing item stat storage...\n";
+    json db = json::parse(R"({"4151": {"name": "Abyssal whip",
+        "equipment": {"attack_slash": 82, "melee_strength": 82, "prayer": 0, "slot": "weapon", "requirements": null},
+        "weapon": {"attack_speed": 4, "weapon_type": "whip", "stances": []},
+        "quest_item": false}})");
+    Item whip(4151);
+    whip.fetchStats(4151, db);
+
+    assert(whip.getName() == "Abyssal whip");
+    assert(whip.getStat(ItemStat::AttackSlash) == 82 && whip.getInt("attack_slash") == 82);
+    assert(whip.getStat(ItemStat::AttackSpeed) == 4);
+    assert(whip.getSlot() == "weapon" && whip.getStr("slot") == "weapon");
+    assert(whip.getWeaponType() == "whip");
+
+    // Keys without a slot still round-trip through the side tables
+    whip.setInt("attack_range", 1);
+    whip.setStr("examine", "A weapon from the abyss.");
+    assert(whip.getInt("attack_range") == 1 && whip.getStr("examine") == "A weapon from the abyss.");
+    assert(whip.getInt("missing") == 0);
+    std::cout << "PASS\n";
+}
+
+void testItemEffects() {
+    std::cout << "Testing item effect registry...\n";
+    assert(Item("Salve amulet(ei)").hasEffect(ItemEffect::SalveEI));
+    assert(Item("Salve amulet(ei)").hasEffect(ItemEffect::Salve));
+    assert(!Item("Salve amulet(ei)").hasEffect(ItemEffect::SalveI));
+    assert(Item("Keris partisan of breaching").hasEffect(ItemEffect::KerisBreaching));
+    assert(Item("Black mask (i)").hasEffect(ItemEffect::SlayerHelmI));
+    assert(Item("Black mask (10)").hasEffect(ItemEffect::SlayerHelm));
+    assert(!Item("Black mask (10)").hasEffect(ItemEffect::SlayerHelmI));
+    assert(Item("Tztok slayer helmet").hasEffect(ItemEffect::SlayerHelm));
+    // Other items named after the helmet or mask are not one
+    assert(!Item("Slayer helmet ornament kit").hasEffect(ItemEffect::SlayerHelm));
+    assert(!Item("Black mask scroll (i)").getEffects());
+
+    // Renaming resolves the traits again on the next read
+    Item mask("Abyssal whip");
+    mask.setName("Black mask (i)");
+    assert(mask.hasEffect(ItemEffect::SlayerHelmI));
+    mask.setName("Abyssal whip");
+    assert(!mask.getEffects());
+
+    // A coloured imbued helm gives the task bonus like the plain one
+    Player onTask("TestPlayer");
+    onTask.setStat("Attack", 99);
+    onTask.setStat("Strength", 99);
+    onTask.equip("weapon", makeWhip());
+    onTask.setSlayerTask(true);
+    Monster dummy("Dummy");
+    dummy.setInt("hitpoints", 250);
+    dummy.setInt("defence_level", 100);
+    double bare = BattleProfile::compile(onTask, dummy).optimalDPS();
+    onTask.equip("head", Item("Hydra slayer helmet (i)"));
+    assert(onTask.getItem(GearSlot::Head)->hasEffect(ItemEffect::SlayerHelmI));
+    double coloured = BattleProfile::compile(onTask, dummy).optimalDPS();
+    onTask.equip("head", Item("Slayer helmet (i)"));
+    assert(coloured > bare && coloured == BattleProfile::compile(onTask, dummy).optimalDPS());
+
+    // Indexed IDs win over the name, and follow setID
+    json db = {{"90001", {{"name", "Twisted bow"}, {"equipment", json::object()}}},
+               {"90002", {{"name", "Twisted bow"}}}};
+    ItemEffectRegistry::instance().indexItemDb(db);
+    Item bow(90001);
+    assert(bow.hasEffect(ItemEffect::TwistedBow));
+    Item renamed("Twisted bow");
+    renamed.setID(90003);
+    assert(renamed.hasEffect(ItemEffect::TwistedBow));
+    Item plain("Twisted bow");
+    plain.setName("Magic shortbow");
+    plain.setID(90001);
+    assert(plain.hasEffect(ItemEffect::TwistedBow));
+    assert(!Item(90002).hasEffect(ItemEffect::TwistedBow));
+    std::cout << "PASS\n";
+}
+
+void testAmmoClasses() {
+    std::cout << "Testing weapon and ammo classes...\n";
+    // Weapon and ammo classes pick which ammo stats count
+    Item karil("Karil's crossbow");
+    karil.setStr("weapon_type", "crossbow");
+    Item rcb("Rune crossbow");
+    rcb.setStr("weapon_type", "crossbow");
+    Item rack("Bolt rack");
+    assert(karil.getWeaponClass() == WeaponClass::KarilsCrossbow && rack.getAmmoClass() == AmmoClass::BoltRack);
+    assert(ammoCompatible(karil.getWeaponClass(), rack.getAmmoClass()));
+    assert(ammoCompatible(rcb.getWeaponClass(), rack.getAmmoClass()));
+    assert(!ammoCompatible(karil.getWeaponClass(), Item("Dragon bolts (e)").getAmmoClass()));
+    assert(!ammoCompatible(WeaponClass::Other, AmmoClass::Arrow));
+    std::cout << "PASS\n";
+}
+
+void testItemArena() {
+    std::cout << "Testing item arena...\n";
+    ItemArena items;
+    Item dbWhip = makeWhip();
+    dbWhip.setID(4151);
+    ItemHandle whipHandle = items.add(dbWhip);
+    assert(items.find(4151) == whipHandle);
+    assert(items.find(1) == kNoItem);
+
+    // Database items are shared by handle, copies share them too
+    Player a("A");
+    a.equip(GearSlot::Weapon, items, whipHandle);
+    assert(a.getItem(GearSlot::Weapon) == &items.get(whipHandle));
+    Player copy = a;
+    assert(copy.getItem(GearSlot::Weapon) == a.getItem(GearSlot::Weapon));
+
+    // Hand-built items are held by the player, not added to the arena
+    Player b("B");
+    b.equip("weapon", dbWhip);
+    assert(b.fingerprint() == a.fingerprint());
+    assert(b.getEquipmentBonus(ItemStat::AttackSlash) == 82);
+    Item whip = *a.getItem(GearSlot::Weapon);
+    whip.setInt("attack_slash", 90);
+    b.equip(GearSlot::Weapon, whip);
+    assert(items.size() == 1);
+    assert(b.getItem(GearSlot::Weapon)->getStat(ItemStat::AttackSlash) == 90);
+    assert(a.getItem(GearSlot::Weapon)->getStat(ItemStat::AttackSlash) == 82);
+    Player bCopy = b;
+    b.unequip(GearSlot::Weapon);
+    assert(bCopy.getItem(GearSlot::Weapon)->getStat(ItemStat::AttackSlash) == 90);
+    std::cout << "PASS\n";
+}
+
+int main() {
+    testItemStats();
+    testItemEffects();
+    testAmmoClasses();
+    testItemArena();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,97 @@
+// test/test_monster.cpp
+#include "../player.h"
+#include "../monster.h"
+#include "../battle.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+
+Monster makeDummy(int hp, int size = 1) {
+    Monster m("Dummy");
+    m.setInt("hitpoints", hp);
+    m.setInt("defence_level", 100);
+    m.setInt("defence_slash", 20);
+    m.setSize(size);
+    return m;
+}
+
+void testMonsterAttributes() {
+    std::cout << "Testing monster attributes...\n";
+    Monster m("Vyrewatch Sentinel");
+    m.addAttribute("vampyre3");
+    m.addAttribute("undead");
+    m.addAttribute("bloated");
+    assert(m.isVampyre() && m.isUndead() && !m.isDemon());
+    assert(m.getVampyreTier() == VampyreTier::Tier3);
+    assert(m.hasAttribute("vampyre3") && !m.hasAttribute("vampyre1") && m.hasAttribute("vampyre"));
+    assert(m.hasAttribute("bloated") && !m.hasAttribute("fiery"));
+
+    m.setStr("attributes", "demon, fiery");
+    assert(m.isDemon() && m.hasAttribute(MonsterAttribute::Fiery) && !m.isVampyre());
+    assert(m.getVampyreTier() == VampyreTier::None);
+    std::cout << "PASS\n";
+}
+
+void testFingerprints() {
+    std::cout << "Testing monster fingerprints...\n";
+    Monster m = makeDummy(250);
+    Monster n = makeDummy(250);
+    assert(m.fingerprint() == n.fingerprint());
+
+    // The whole combat state moves with either side
+    Player a("TestPlayer");
+    Player b("TestPlayer");
+    assert(stateFingerprint(a, m) == stateFingerprint(b, n));
+    n.setInt("defence_level", 1);
+    assert(m.fingerprint() != n.fingerprint() && stateFingerprint(a, m) != stateFingerprint(a, n));
+    b.setPiety(true);
+    assert(stateFingerprint(a, m) != stateFingerprint(b, m));
+    std::cout << "PASS\n";
+}
+
+void testMonsterCombat() {
+    std::cout << "Testing monster combat record...\n";
+    // The record follows the stat setters
+    Monster dummy = makeDummy(250, 2);
+    const MonsterCombat& combat = dummy.combat();
+    assert(combat.hitpoints == 250 && combat.size == 2);
+    assert(combat.defenceRoll[static_cast<int>(DefenceStyle::Slash)] == 109 * 84);
+    assert(combat.defenceRoll[static_cast<int>(DefenceStyle::Magic)] == 109 * 64);
+    dummy.setInt("defence_level", 1);
+    assert(combat.defenceRoll[static_cast<int>(DefenceStyle::Slash)] == 10 * 84);
+    std::cout << "PASS\n";
+}
+
+void testMonsterLoad() {
+    std::cout << "Testing monster loading...\n";
+    const char* path = "test_monster_load.tmp";
+    {
+        std::ofstream out(path);
+        out << R"json({"1": {"name": "Molanisk", "hitpoints": 52, "combat_level": 51, "defence_level": 50,
+            "defence_slash": 45, "slayer_level": 39, "examine": "A strange mole-like being.",
+            "wiki_url": "https://oldschool.runescape.wiki/w/Molanisk", "members": true,
+            "attributes": ["rat"]}})json";
+    }
+    Monster m("Molanisk");
+    m.loadFromJSON(path);
+    std::remove(path);
+
+    // Combat stats and attributes are kept, metadata is not
+    assert(m.getInt("hitpoints") == 52 && m.getInt("combat_level") == 51);
+    assert(m.combat().defenceRoll[static_cast<int>(DefenceStyle::Slash)] == 59 * 109);
+    assert(m.hasAttribute(MonsterAttribute::Rat));
+    assert(!m.hasInt("slayer_level") && m.getStr("examine").empty() && m.getStr("wiki_url").empty());
+    assert(!m.getBool("members"));
+    std::cout << "PASS\n";
+}
+
+int main() {
+    testMonsterAttributes();
+    testFingerprints();
+    testMonsterCombat();
+    testMonsterLoad();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,171 @@
+// test/test_player.cpp
+#include "../player.h"
+#include "../loadout.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+
+Player makeWhipPlayer() {
+    Player p("TestPlayer");
+    p.setStat("Attack", 99);
+    p.setStat("Strength", 99);
+
+    Item whip("Abyssal whip");
+    whip.setInt("attack_slash", 82);
+    whip.setInt("strength_bonus", 82);
+    whip.setInt("attack_speed", 4);
+    p.equip("weapon", whip);
+    return p;
+}
+
+void testGearSlots() {
+    std::cout << "Testing gear slots...\n";
+    Player p = makeWhipPlayer();
+    const Item* weapon = p.getItem(GearSlot::Weapon);
+    assert(weapon && weapon->getName() == "Abyssal whip");
+    assert(p.getLoadout().get(GearSlot::Weapon) == weapon);
+
+    // "2h" is the weapon slot; unknown slot names are ignored
+    p.equip("2h", Item("Scythe of vitur"));
+    assert(p.getItem(GearSlot::Weapon)->getName() == "Scythe of vitur");
+    p.equip("pocket", Item("Rune pouch"));
+    assert(!p.hasEquipped("Rune pouch") && !p.hasItem("pocket"));
+
+    p.unequip("weapon");
+    assert(!p.getItem(GearSlot::Weapon) && p.getEquippedItem("weapon").getName().empty());
+    std::cout << "PASS\n";
+}
+
+void testBonusTotals() {
+    std::cout << "Testing equipment bonus totals...\n";
+    Player p = makeWhipPlayer();
+
+    // Running totals follow equip, replace and unequip
+    Item torture("Amulet of torture");
+    torture.setInt("attack_slash", 15);
+    p.equip("neck", torture);
+    assert(p.getEquipmentBonus(ItemStat::AttackSlash) == 97 && p.getEquipmentBonus("attack_slash") == 97);
+    Loadout view = p.getLoadout();
+    view.set(GearSlot::Neck, nullptr);
+    assert(view.bonus(ItemStat::AttackSlash) == 82 && view.bonus(ItemStat::StrengthBonus) == 82);
+    p.unequip(GearSlot::Neck);
+    assert(p.getEquipmentBonus(ItemStat::AttackSlash) == 82);
+    std::cout << "PASS\n";
+}
+
+void testSkillLevels() {
+    std::cout << "Testing skill levels...\n";
+    Player p("test");
+    assert(p.getStat(Skill::Attack) == 1 && p.getStat("Nonsense") == 0);
+    p.setStat("Attack", 99);
+    p.setStat("Nonsense", 50);
+    assert(p.getStat(Skill::Attack) == 99 && p.getStat("Nonsense") == 0);
+    assert(p.getBoostedLevel(Skill::Attack) == 99);
+
+    // Potion boosts follow both the level and the potion state
+    p.setSuperCombat(true);
+    assert(p.getBoostedLevel(Skill::Attack) == 118 && p.getBoostedLevel("Attack") == 118);
+    assert(p.getBoostedLevel(Skill::Strength) == 6 && p.getBoostedLevel(Skill::Ranged) == 1);
+    p.setStat(Skill::Attack, 60);
+    assert(p.getBoostedLevel(Skill::Attack) == 74);
+    p.setSuperCombat(false);
+    assert(p.getBoostedLevel(Skill::Attack) == 60);
+
+    const Player copy = p;
+    assert(copy.getStat(Skill::Attack) == 60 && std::string(skillName(Skill::Hitpoints)) == "Hitpoints");
+    std::cout << "PASS\n";
+}
+
+void testGearSets() {
+    std::cout << "Testing gear set tracking...\n";
+    Player p("test");
+    p.equip(GearSlot::Head, Item("Void melee helm"));
+    p.equip(GearSlot::Body, Item("Elite void top"));
+    p.equip(GearSlot::Legs, Item("Elite void robe"));
+    assert(p.getActiveSet() == "");
+    p.equip(GearSlot::Hands, Item("Void knight gloves"));
+    assert(p.getActiveSet() == "Elite Void Melee");
+
+    // Plain void accepts elite pieces; the view tracks sets the same way
+    p.equip(GearSlot::Legs, Item("Void knight robe"));
+    assert(p.getActiveSet() == "Void Melee");
+    Loadout view = p.getLoadout();
+    assert(view.activeGearSet() == GearSet::VoidMelee);
+    Item helm("Inquisitor's great helm");
+    Item hauberk("Inquisitor's hauberk");
+    view.set(GearSlot::Head, &helm);
+    view.set(GearSlot::Body, &hauberk);
+    assert(view.activeGearSet() == GearSet::None && view.setPieces(GearSet::Inquisitor) == 2);
+    assert(view.setPieces(GearSet::VoidMelee) == 2);
+
+    p.clearGear();
+    p.equip(GearSlot::Head, Item("Crystal helm"));
+    p.equip(GearSlot::Legs, Item("Crystal legs"));
+    assert(p.countCrystalPieces() == 2 && p.getActiveSet() == "");
+    std::cout << "PASS\n";
+}
+
+void testLoadoutWear() {
+    std::cout << "Testing loadout wear...\n";
+    Player p = makeWhipPlayer();
+    Loadout view = p.getLoadout();
+
+    // wear() applies the two-handed rules on a copy, leaving the base alone
+    Item defender("Dragon defender");
+    defender.setStr("slot", "shield");
+    Item scythe("Scythe of vitur");
+    scythe.setStr("slot", "2h");
+    view.set(GearSlot::Shield, &defender);
+    Loadout twoHanded = view;
+    twoHanded.wear(GearSlot::Weapon, &scythe);
+    assert(!twoHanded.get(GearSlot::Shield) && view.get(GearSlot::Shield) == &defender);
+    twoHanded.wear(GearSlot::Shield, &defender);
+    assert(!twoHanded.get(GearSlot::Weapon) && twoHanded.get(GearSlot::Shield) == &defender);
+    std::cout << "PASS\n";
+}
+
+void testFingerprints() {
+    std::cout << "Testing player fingerprints...\n";
+    Player a = makeWhipPlayer();
+    Player b = makeWhipPlayer();
+    assert(a.fingerprint() == b.fingerprint());
+
+    // Every setter moves it, and undoing the change restores it
+    uint64_t base = a.fingerprint();
+    a.setPiety(true);
+    assert(a.fingerprint() != base);
+    a.setPiety(false);
+    a.setStat(Skill::Attack, 80);
+    assert(a.fingerprint() != base);
+    a.setStat(Skill::Attack, 99);
+    a.setHP(50, 99);
+    assert(a.fingerprint() != base);
+    a.setHP(99, 99);
+    assert(a.fingerprint() == base);
+
+    Item whip = *a.getItem(GearSlot::Weapon);
+    a.unequip(GearSlot::Weapon);
+    assert(a.fingerprint() != base);
+    a.equip(GearSlot::Weapon, whip);
+    assert(a.fingerprint() == base);
+
+    // Order of changes does not matter
+    a.setSlayerTask(true);
+    a.setSuperCombat(true);
+    b.setSuperCombat(true);
+    b.setSlayerTask(true);
+    assert(a.fingerprint() == b.fingerprint());
+    std::cout << "PASS\n";
+}
+
+int main() {
+    testGearSlots();
+    testBonusTotals();
+    testSkillLevels();
+    testGearSets();
+    testLoadoutWear();
+    testFingerprints();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
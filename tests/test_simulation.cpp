@@ -0,0 +1,487 @@
+// test/test_simulation.cpp
+#include "../battle.h"
+#include "../player.h"
+#include "../monster.h"
+#include "../sim_kernel.h"
+#include "../damage_table.h"
+#include "../rng.h"
+#include "../battle_profile.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+Player makeWhipPlayer() {
+    Player p("TestPlayer");
+    p.setStat("Attack", 99);
+    p.setStat("Strength", 99);
+
+    Item whip("Abyssal whip");
+    whip.setInt("attack_slash", 82);
+    whip.setInt("strength_bonus", 82);
+    whip.setInt("attack_speed", 4);
+    p.equip("weapon", whip);
+    return p;
+}
+
+Monster makeDummy(int hp, int size = 1) {
+    Monster m("Dummy");
+    m.setInt("hitpoints", hp);
+    m.setInt("defence_level", 100);
+    m.setInt("defence_slash", 20);
+    m.setSize(size);
+    return m;
+}
+
+// Battle with its attack style already chosen
+Battle readyBattle(const Player& p, const Monster& m) {
+    Battle b(p, m);
+    b.optimizeAttackStyle();
+    return b;
+}
+
+Battle whipBattle(int hp = 250, int size = 1) {
+    return readyBattle(makeWhipPlayer(), makeDummy(hp, size));
+}
+
+void testExactTTKMatchesMonteCarlo() {
+    std::cout << "Testing exact TTK solver...\n";
+    Battle b = whipBattle(250);
+    TTKDistribution ttk = b.solveTTK();
+    double simTicks = b.runSimulations(20000);
+
+    std::cout << "Exact: " << ttk.expectedTicks << " ticks, MC: " << simTicks << " ticks\n";
+    assert(ttk.killable);
+    assert(std::fabs(ttk.expectedTicks - simTicks) / ttk.expectedTicks < 0.02);
+    assert(ttk.p50Ticks <= ttk.p90Ticks && ttk.p90Ticks <= ttk.p99Ticks);
+    assert(ttk.varianceTicks > 0.0);
+
+    // Overkill means the exact TTK is never below HP / DPS
+    double naiveSeconds = 250 / b.getDPS();
+    assert(ttk.expectedSeconds >= naiveSeconds);
+    std::cout << "PASS\n";
+}
+
+void testExactTTKScythe() {
+    std::cout << "Testing exact TTK solver with Scythe...\n";
+    Player p("TestPlayer");
+    p.setStat("Attack", 99);
+    p.setStat("Strength", 99);
+
+    Item scythe("Scythe of vitur");
+    scythe.setInt("strength_bonus", 75);
+    scythe.setInt("attack_slash", 110);
+    scythe.setInt("attack_speed", 5);
+    p.equip("weapon", scythe);
+
+    Battle b = readyBattle(p, makeDummy(400, 3));
+    TTKDistribution ttk = b.solveTTK();
+    double simTicks = b.runSimulations(20000);
+
+    std::cout << "Exact: " << ttk.expectedTicks << " ticks, MC: " << simTicks << " ticks\n";
+    assert(std::fabs(ttk.expectedTicks - simTicks) / ttk.expectedTicks < 0.02);
+    std::cout << "PASS\n";
+}
+
+void testExactTTKLongFight() {
+    std::cout << "Testing exact TTK solver on a long fight...\n";
+    Player p("TestPlayer");
+    Monster m("Tank");
+    m.setInt("hitpoints", 20000);
+    m.setInt("defence_level", 400);
+    m.setInt("defence_crush", 300);
+
+    Battle b = readyBattle(p, m);
+    TTKDistribution ttk = b.solveTTK();
+
+    // Too long to step through, so the tail is fitted but never left at 0
+    std::cout << "Mean: " << ttk.expectedTicks << " ticks, p50/p90/p99: " << ttk.p50Ticks << "/"
+              << ttk.p90Ticks << "/" << ttk.p99Ticks << "\n";
+    assert(ttk.killable && !ttk.percentilesExact);
+    assert(ttk.p50Ticks > 0 && ttk.p50Ticks <= ttk.p90Ticks && ttk.p90Ticks <= ttk.p99Ticks);
+    assert(std::fabs(ttk.p50Ticks - ttk.expectedTicks) / ttk.expectedTicks < 0.1);
+    assert(b.getResults().ttkP50 > 0.0);
+
+    // Short fights are still stepped exactly
+    assert(whipBattle().solveTTK().percentilesExact);
+    std::cout << "PASS\n";
+}
+
+void testParallelDeterminism() {
+    std::cout << "Testing parallel simulation determinism...\n";
+    Battle b = whipBattle();
+
+    double one = b.runSimulations(30000, 1, 42);
+    double four = b.runSimulations(30000, 4, 42);
+    double seven = b.runSimulations(30000, 7, 42);
+    double other = b.runSimulations(30000, 4, 43);
+
+    std::cout << "1 thread: " << one << ", 4 threads: " << four << ", 7 threads: " << seven << "\n";
+    assert(one == four && four == seven);
+    assert(one != other);
+    std::cout << "PASS\n";
+}
+
+void testBatchedBackendsAgree() {
+    std::cout << "Testing batched kernel backends...\n";
+    DamageTable table({40, 0.65, 3, false, true});
+    SimAttackParams params {300, table.columns(), table.acceptData(), table.aliasData()};
+
+    TTKSketch scalarSketch;
+    SimStats scalar = simulateFightsBatched(params, 7, 5000, SimBackend::Scalar, &scalarSketch);
+    assert(scalar.fights == 5000 && scalarSketch.fights() == 5000);
+    for (SimBackend backend : {SimBackend::SSE2, SimBackend::AVX2}) {
+        if (!simBackendAvailable(backend)) continue;
+        TTKSketch sketch;
+        SimStats vec = simulateFightsBatched(params, 7, 5000, backend, &sketch);
+        std::cout << simBackendName(backend) << ": " << vec.attacks << " attacks, scalar: " << scalar.attacks << "\n";
+        assert(vec.fights == scalar.fights && vec.attacks == scalar.attacks && vec.attacksSq == scalar.attacksSq);
+        assert(sketch.histogram(1, 64).counts == scalarSketch.histogram(1, 64).counts);
+    }
+    std::cout << "PASS\n";
+}
+
+void testDamageTable() {
+    std::cout << "Testing damage table...\n";
+    AttackShape shape {45, 0.7, 2, true, false};
+    DamageTable table(shape);
+
+    double total = 0.0;
+    for (double p : table.pmf()) total += p;
+    assert(std::fabs(total - 1.0) < 1e-9);
+    assert(std::fabs(table.mean() - DamageTable::expectedDamage(shape)) < 1e-9);
+
+    // Alias table reproduces the PMF
+    std::vector<double> rebuilt(table.columns(), 0.0);
+    for (int c = 0; c < table.columns(); ++c) {
+        double keep = table.acceptData()[c] / 16777216.0;
+        rebuilt[c] += keep / table.columns();
+        rebuilt[table.aliasData()[c]] += (1.0 - keep) / table.columns();
+    }
+    for (int d = 0; d < table.columns(); ++d) {
+        assert(std::fabs(rebuilt[d] - table.pmf()[d]) < 1e-6);
+    }
+    std::cout << "PASS\n";
+}
+
+void testDamageTableNearZeroAccuracy() {
+    std::cout << "Testing damage table with near-zero accuracy...\n";
+    // Every hit column is far below one 2^-24 threshold step
+    DamageTable table(AttackShape {50, 1e-9, 1, false, false});
+    assert(table.canDamage());
+    for (int c = 1; c < table.columns(); ++c) {
+        assert(table.pmf()[c] > 0.0 && table.acceptData()[c] > 0);
+    }
+
+    // A rare hit is still drawn, so the fight ends
+    uint32_t lastColumn = static_cast<uint32_t>(table.columns() - 1);
+    uint64_t u = ((static_cast<uint64_t>(lastColumn) << 32) + table.columns() - 1) / table.columns();
+    assert(table.sample(u) == table.maxDamage());
+
+    assert(!DamageTable(AttackShape {50, 0.0, 1, false, false}).canDamage());
+    std::cout << "PASS\n";
+}
+
+template <class Rng>
+void checkEngine(Battle& b, double expectedTicks) {
+    Rng a(99);
+    Rng c(99);
+    for (int i = 0; i < 100; ++i) assert(a() == c());
+
+    Rng rng(1234);
+    long long total = 0;
+    const int fights = 20000;
+    for (int i = 0; i < fights; ++i) total += b.simulate(rng);
+    double avg = static_cast<double>(total) / fights;
+
+    std::cout << Rng::name << ": " << avg << " ticks\n";
+    assert(std::fabs(avg - expectedTicks) / expectedTicks < 0.02);
+}
+
+void testRngEngines() {
+    std::cout << "Testing RNG engines...\n";
+    Battle b = whipBattle();
+
+    double expected = b.solveTTK().expectedTicks;
+
+    checkEngine<Xoshiro256ss>(b, expected);
+    checkEngine<Pcg64>(b, expected);
+    checkEngine<Philox4x32>(b, expected);
+    std::cout << "PASS\n";
+}
+
+void testLoadoutEvaluation() {
+    std::cout << "Testing loadout DPS evaluation...\n";
+    Player p = makeWhipPlayer();
+    Monster m = makeDummy(250);
+
+    Item helm("Slayer helmet");
+    helm.setInt("attack_slash", 0);
+    p.setSlayerTask(true);
+
+    // Trying the helm on through a view matches a Battle on an equipped copy
+    Loadout view = p.getLoadout();
+    view.set(GearSlot::Head, &helm);
+    double viewDps = BattleProfile::compile(p, view, m).optimalDPS();
+
+    Player equipped = p;
+    equipped.equip("head", helm);
+    Battle b(equipped, m);
+    double battleDps = b.solveOptimalDPS();
+
+    std::cout << "View: " << viewDps << ", Battle: " << battleDps << "\n";
+    assert(viewDps == battleDps);
+    assert(viewDps > BattleProfile::compile(p, m).optimalDPS());
+    std::cout << "PASS\n";
+}
+
+void testStanceTable() {
+    std::cout << "Testing stance table...\n";
+    Player p = makeWhipPlayer();
+    p.setStat("Ranged", 99);
+    Monster m = makeDummy(250);
+
+    Battle b(p, m);
+    double best = b.solveOptimalDPS();
+    StanceTable table = b.getStanceTable();
+    const BattleProfile& profile = b.getProfile();
+
+    assert(table.count == 12);
+    assert(table.rows[table.best].dps == best);
+    for (int i = 0; i < table.count; ++i) {
+        const StanceDPS& row = table.rows[i];
+        const StanceOption& o = row.option;
+        std::cout << combatStyleName(o.style) << " " << o.name << ": " << row.dps << "\n";
+        // The shared pass agrees with evaluating each stance on its own
+        assert(row.maxHit == profile.maxHit(o.style, o.stanceStrength));
+        assert(row.hitChance == profile.hitChance(o.style, o.stanceAttack));
+        assert(row.dps == profile.dps(o.style, o.stanceAttack, o.stanceStrength, row.attackSpeed));
+        assert(row.dps <= best);
+    }
+    std::cout << "PASS\n";
+}
+
+void testAdaptivePrecision() {
+    std::cout << "Testing adaptive-precision simulation...\n";
+    Battle b = whipBattle();
+
+    double exact = b.solveTTK().expectedTicks;
+
+    PrecisionTarget target;
+    target.relativeError = 0.01;
+    SimulationEstimate est = b.runSimulationsAdaptive(target, 1, 42);
+    SimulationEstimate again = b.runSimulationsAdaptive(target, 3, 42);
+
+    std::cout << "Mean: " << est.meanTicks << " +- " << est.ciHalfWidthTicks
+              << " ticks after " << est.fights << " fights (exact " << exact << ")\n";
+    assert(est.converged);
+    assert(est.ciHalfWidthTicks <= 0.01 * est.meanTicks);
+    assert(est.fights < target.maxFights);
+    assert(std::fabs(est.meanTicks - exact) < 4.0 * est.stdErrorTicks);
+    assert(again.fights == est.fights && again.meanTicks == est.meanTicks);
+
+    // A loose target stops after the first round
+    target.relativeError = 0.05;
+    assert(b.runSimulationsAdaptive(target, 1, 42).fights == target.minFights);
+    std::cout << "PASS\n";
+}
+
+void testLongFightVariance() {
+    std::cout << "Testing simulated variance of long fights...\n";
+    // Max hit 1 at low accuracy: fights run past 65536 attacks, so K^2 needs 64 bits
+    Monster m("Tank");
+    m.setInt("hitpoints", 1000);
+    m.setInt("defence_level", 400);
+    m.setInt("defence_crush", 400);
+    Battle b = readyBattle(Player("TestPlayer"), m);
+    TTKDistribution ttk = b.solveTTK();
+    assert(b.getMaxHit() == 1 && ttk.expectedAttacks > 65536);
+
+    PrecisionTarget target;
+    target.relativeError = 0.0;
+    target.minFights = 2048;
+    target.maxFights = 2048;
+    SimulationEstimate est = b.runSimulationsAdaptive(target, 0, 5);
+    double variance = est.stdErrorTicks * est.stdErrorTicks * est.fights;
+    std::cout << "Variance: " << variance << " (exact " << ttk.varianceTicks << ")\n";
+    assert(std::fabs(variance / ttk.varianceTicks - 1.0) < 0.25);
+
+    DamageTable table({1, 0.03, 1, false, false});
+    SimAttackParams params {1000, table.columns(), table.acceptData(), table.aliasData()};
+    SimStats scalar = simulateFightsBatched(params, 3, 16, SimBackend::Scalar);
+    for (SimBackend backend : {SimBackend::SSE2, SimBackend::AVX2}) {
+        if (!simBackendAvailable(backend)) continue;
+        SimStats vec = simulateFightsBatched(params, 3, 16, backend);
+        assert(vec.attacks == scalar.attacks && vec.attacksSq == scalar.attacksSq);
+    }
+    std::cout << "PASS\n";
+}
+
+void testVarianceReduction() {
+    std::cout << "Testing variance-reduced simulation...\n";
+    Battle b = whipBattle();
+
+    double exact = b.solveTTK().expectedTicks;
+
+    SimulationEstimate est = b.runSimulationsReduced(20000, 1, 42);
+    std::cout << "Mean: " << est.meanTicks << " +- " << est.stdErrorTicks << " (exact " << exact
+              << "), variance reduction " << est.varianceReduction << "x\n";
+    assert(std::fabs(est.meanTicks - exact) < 4.0 * est.stdErrorTicks);
+    assert(est.varianceReduction > 2.0);
+    assert(b.runSimulationsReduced(20000, 3, 42).meanTicks == est.meanTicks);
+
+    // Paired backends agree bit for bit
+    DamageTable table({40, 0.65, 3, false, true});
+    SimAttackParams params {300, table.columns(), table.acceptData(), table.aliasData()};
+    PairedSimStats scalar = simulatePairsBatched(params, 7, 999, SimBackend::Scalar);
+    assert(scalar.pairs == 999);
+    for (SimBackend backend : {SimBackend::SSE2, SimBackend::AVX2}) {
+        if (!simBackendAvailable(backend)) continue;
+        PairedSimStats vec = simulatePairsBatched(params, 7, 999, backend);
+        assert(vec.attacks == scalar.attacks && vec.attacksSq == scalar.attacksSq &&
+               vec.cross == scalar.cross && vec.fightAttacksSq == scalar.fightAttacksSq);
+    }
+
+    // Same precision target, fewer fights
+    PrecisionTarget target;
+    target.relativeError = 0.005;
+    int plainFights = b.runSimulationsAdaptive(target, 1, 42).fights;
+    target.reduceVariance = true;
+    SimulationEstimate reduced = b.runSimulationsAdaptive(target, 1, 42);
+    std::cout << "Fights for 0.5%: " << plainFights << " plain, " << reduced.fights << " reduced\n";
+    assert(reduced.converged && reduced.fights < plainFights);
+    std::cout << "PASS\n";
+}
+
+void testLongFightPairs() {
+    std::cout << "Testing variance-reduced simulation of long fights...\n";
+    Monster m("Tank");
+    m.setInt("hitpoints", 1000);
+    m.setInt("defence_level", 400);
+    m.setInt("defence_crush", 400);
+    Battle b = readyBattle(Player("TestPlayer"), m);
+    TTKDistribution ttk = b.solveTTK();
+
+    // Pair sums pass 2^16 attacks, so their squares and cross terms need 64 bits
+    SimulationEstimate est = b.runSimulationsReduced(1024, 0, 5);
+    std::cout << "Mean: " << est.meanTicks << " +- " << est.stdErrorTicks << " (exact "
+              << ttk.expectedTicks << "), variance reduction " << est.varianceReduction << "x\n";
+    assert(est.stdErrorTicks > 0.0 && est.varianceReduction >= 1.0);
+    assert(std::fabs(est.meanTicks - ttk.expectedTicks) < 4.0 * est.stdErrorTicks);
+
+    DamageTable table({1, 0.03, 1, false, false});
+    SimAttackParams params {1000, table.columns(), table.acceptData(), table.aliasData()};
+    PairedSimStats scalar = simulatePairsBatched(params, 3, 8, SimBackend::Scalar);
+    for (SimBackend backend : {SimBackend::SSE2, SimBackend::AVX2}) {
+        if (!simBackendAvailable(backend)) continue;
+        PairedSimStats vec = simulatePairsBatched(params, 3, 8, backend);
+        assert(vec.attacksSq == scalar.attacksSq && vec.cross == scalar.cross &&
+               vec.fightAttacksSq == scalar.fightAttacksSq);
+    }
+
+    // An odd fight budget stops on a whole pair
+    PrecisionTarget target;
+    target.relativeError = 0.0;
+    target.reduceVariance = true;
+    target.minFights = 301;
+    target.maxFights = 301;
+    assert(whipBattle().runSimulationsAdaptive(target, 1, 42).fights == 300);
+    std::cout << "PASS\n";
+}
+
+void testSeedManifest() {
+    std::cout << "Testing seeded runs and manifests...\n";
+    Battle a = whipBattle();
+    Battle b = whipBattle();
+    a.setSeed(2024);
+    b.setSeed(2024);
+    for (int i = 0; i < 50; ++i) assert(a.simulate() == b.simulate());
+    assert(a.runSimulations(5000) == b.runSimulations(5000));
+
+    // A manifest survives JSON and replays to the same ticks
+    double ticks = a.runSimulations(5000, 2, 77);
+    RunManifest recorded;
+    assert(RunManifest::fromJson(a.getLastRun().toJson(), recorded));
+    std::cout << a.getLastRun().toJson() << "\n";
+    assert(recorded.seed == 77 && recorded.fights == 5000 && recorded.meanTicks == ticks);
+    assert(b.replay(recorded, 3));
+
+    // A different scenario refuses the manifest
+    Battle other = whipBattle(300);
+    assert(other.scenarioFingerprint()
+ != a.scenarioFingerprint());
+    assert(!other.replay(recorded));
+    std::cout << "PASS\n";
+}
+
+void testTTKSketch() {
+    std::cout << "Testing kill-time sketch...\n";
+    Battle b = whipBattle();
+    TTKDistribution ttk = b.solveTTK();
+    int speed = b.getAttackSpeed();
+
+    b.runSimulations(50000, 1, 9);
+    TTKSketch one = b.getLastSketch();
+    b.runSimulations(50000, 4, 9);
+    const TTKSketch& four = b.getLastSketch();
+
+    // Split across threads, the distribution is the same
+    TTKHistogram h1 = one.histogram(speed);
+    TTKHistogram h4 = four.histogram(speed);
+    assert(h1.counts == h4.counts && h1.startTicks == h4.startTicks);
+
+    uint64_t total = 0;
+    for (uint64_t c : h1.counts) total += c;
+    assert(one.fights() == 50000 && total == 50000);
+
+    // Percentiles agree with the exact solver within one attack
+    double p50 = one.quantileAttacks(0.5) * speed;
+    double p90 = one.quantileAttacks(0.9) * speed;
+    std::cout << "p50 " << p50 << " (exact " << ttk.p50Ticks << "), p90 " << p90
+              << " (exact " << ttk.p90Ticks << "), " << h1.counts.size() << " buckets of "
+              << h1.bucketTicks << " ticks\n";
+    assert(std::fabs(p50 - ttk.p50Ticks) <= speed && std::fabs(p90 - ttk.p90Ticks) <= speed);
+
+    // Long fights fall in log buckets: within 1% and still mergeable
+    TTKSketch a, c;
+    for (uint32_t v = 1; v <= 100000; v += 7) (v % 2 ? a : c).add(v * 37);
+    a.merge(c);
+    double median = a.quantileAttacks(0.5);
+    assert(std::fabs(median - 50000.0 * 37) / (50000.0 * 37) < 0.011);
+
+    BattleResult r = b.getResults();
+    assert(r.simTTKP50 > 0.0 && r.simTTKP50 <= r.simTTKP90 && r.simTTKP90 <= r.simTTKP99);
+    assert(!r.ttkHistogram.counts.empty());
+
+    // Battles that never simulate do not carry a sketch
+    static_assert(sizeof(Battle) < sizeof(TTKSketch), "sketch is held out of line");
+
+    // getResults never simulates on its own
+    Battle fresh(makeWhipPlayer(), makeDummy(250));
+    BattleResult none
+ = fresh.getResults();
+    assert(none.simTTKP50 == 0.0 && none.ttkHistogram.counts.empty());
+    assert(fresh.getLastRun().fights == 0);
+    std::cout << "PASS\n";
+}
+
+int main() {
+    testExactTTKMatchesMonteCarlo();
+    testExactTTKScythe();
+    testExactTTKLongFight();
+    testParallelDeterminism();
+    testBatchedBackendsAgree();
+    testDamageTable();
+    testDamageTableNearZeroAccuracy();
+    testRngEngines();
+    testLoadoutEvaluation();
+    testStanceTable();
+    testAdaptivePrecision();
+    testLongFightVariance();
+    testVarianceReduction();
+    testLongFightPairs();
+    testSeedManifest();
+    testTTKSketch();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
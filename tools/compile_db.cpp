@@ -0,0 +1,65 @@
+// compile_db.cpp
+// Compiles the JSON data files into the binary database the calculator maps.
+// Usage: osrsdb [out.db [items.json prices.json monsters.json...]]
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "binary_db.h"
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+// A missing file compiles to an empty table, as the calculator treats it
+json loadJSON(const std::string& filename) {
+    std::ifstream f(filename);
+    if (!f.is_open()) {
+        std::cerr << "Warning: Could not open " << filename << "\n";
+        return json::object();
+    }
+    try {
+        return json::parse(f);
+    } catch (const std::exception& e) {
+        std::cerr << "Error parsing " << filename << ": " << e.what() << "\n";
+        return json::object();
+    }
+}
+}
+
+int main(int argc, char** argv) {
+    std::string outPath = argc > 1 ? argv[1] : "data/osrs.db";
+    std::string itemsPath = argc > 2 ? argv[2] : "data/items-complete.json";
+    std::string pricesPath = argc > 3 ? argv[3] : "data/latest_prices.json";
+    std::vector<std::string> monsterPaths;
+    for (int i = 4; i < argc; ++i) monsterPaths.push_back(argv[i]);
+    if (monsterPaths.empty()) monsterPaths = {"data/monsters-nodrops.json", "data/bosses_complete.json"};
+
+    json items = loadJSON(itemsPath);
+    json prices = loadJSON(pricesPath);
+    std::vector<json> monsters;
+    for (const auto& path : monsterPaths) monsters.push_back(loadJSON(path));
+
+    std::string contents = binarydb::compile(items, prices, monsters);
+
+    // Write beside the target and rename, so running calculators keep
+    // their mapping of the old file
+    std::string tmpPath = outPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(contents.data(), static_cast<std::streamsize>(contents.size()))) {
+            std::cerr << "Could not write " << tmpPath << "\n";
+            return 1;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), outPath.c_str()) != 0) {
+        std::cerr << "Could not replace " << outPath << "\n";
+        return 1;
+    }
+
+    BinaryDb db;
+    if (!db.load(contents)) return 1;
+    std::cout << "Wrote " << outPath << " (format " << binarydb::kVersion << ", " << contents.size() << " bytes): "
+              << db.itemCount() << " items, " << db.monsterCount() << " monsters, " << db.priceCount() << " prices\n";
+    return 0;
+}